@@ -1,6 +1,6 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 CONFIG += c++11
 
@@ -17,13 +17,17 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
     delegates.cpp \
+    duplicatefinder.cpp \
     editormanager.cpp \
     editormodel.cpp \
     editormodelitem.cpp \
     editorobject.cpp \
     exceptions.cpp \
+    filterplan.cpp \
     filterproxymodel.cpp \
     geodesicdome.cpp \
+    jsonreader.cpp \
+    jsonwriter.cpp \
     main.cpp \
     mainwindow.cpp \
     mainwindow_archive.cpp \
@@ -35,29 +39,60 @@ SOURCES += \
     nodeeditor.cpp \
     nodefilter.cpp \
     opentrackdialog.cpp \
+    prefabregistry.cpp \
+    scankernels.cpp \
+    searchfilter.cpp \
     searchfilterlayout.cpp \
+    searchquery.cpp \
+    spatialindex.cpp \
+    sqliteconnection.cpp \
     track.cpp \
     trackarchive.cpp \
+    trackcache.cpp \
+    trackcatalogloader.cpp \
+    trackcatalogmodel.cpp \
+    trackindex.cpp \
+    trackindexer.cpp \
+    trackstatistics.cpp \
+    trackstore.cpp \
     velodataparser.cpp \
     velodb.cpp
 
 HEADERS += \
     delegates.h \
+    duplicatefinder.h \
     editormanager.h \
     editormodel.h \
     editormodelitem.h \
     editorobject.h \
     exceptions.h \
+    filterplan.h \
     filterproxymodel.h \
     geodesicdome.h \
+    jsonreader.h \
+    jsonwriter.h \
     mainwindow.h \
     nodeeditor.h \
     nodefilter.h \
+    objectpool.h \
     opentrackdialog.h \
+    prefabregistry.h \
+    scankernels.h \
+    searchfilter.h \
     searchfilterlayout.h \
+    searchquery.h \
+    spatialindex.h \
+    sqliteconnection.h \
     sqlite3.h \
     track.h \
     trackarchive.h \
+    trackcache.h \
+    trackcatalogloader.h \
+    trackcatalogmodel.h \
+    trackindex.h \
+    trackindexer.h \
+    trackstatistics.h \
+    trackstore.h \
     velodataparser.h \
     velodb.h
 
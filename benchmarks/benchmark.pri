@@ -0,0 +1,26 @@
+# Builds a benchmark against the sources of the toolbox itself, everything but its main()
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+TOOLBOX_DIR = $$PWD/..
+
+SOURCES += $$files($$TOOLBOX_DIR/*.cpp)
+SOURCES -= $$TOOLBOX_DIR/main.cpp
+HEADERS += $$files($$TOOLBOX_DIR/*.h)
+FORMS += $$files($$TOOLBOX_DIR/*.ui)
+RESOURCES += $$TOOLBOX_DIR/icons.qrc
+
+win32: LIBS += -L$$TOOLBOX_DIR -lsqlite3
+else:unix: LIBS += -L$$TOOLBOX_DIR -lsqlite3
+
+SOURCES += $$PWD/benchmarktrack.cpp
+HEADERS += $$PWD/benchmarktrack.h
+
+INCLUDEPATH += $$TOOLBOX_DIR $$PWD
+DEPENDPATH += $$TOOLBOX_DIR $$PWD
@@ -0,0 +1,46 @@
+#include "benchmarktrack.h"
+
+#include <algorithm>
+#include <QString>
+
+PrefabRegistryPtr BenchmarkTrack::createRegistry()
+{
+  QVector<PrefabData> prefabs;
+  for (uint id = 1; id <= 4; ++id) {
+    PrefabData prefab;
+    prefab.id = id;
+    prefab.name = QString("Barrier %1").arg(id);
+    prefab.type = "barrier";
+    prefabs.append(prefab);
+  }
+
+  return PrefabRegistryPtr(new PrefabRegistry(prefabs));
+}
+
+QByteArray BenchmarkTrack::generateJson(const int objectCount)
+{
+  QByteArray json;
+  json.reserve(objectCount * 120);
+  json.append("{\"barriers\":[");
+  for (int i = 0; i < objectCount; ++i) {
+    if (i > 0)
+      json.append(',');
+
+    // Every hundredth object carries a member the parser does not know, so the spans get exercised too
+    json.append("{\"prefab\":").append(QByteArray::number(1 + i % 4));
+    if (i % 100 == 0)
+      json.append(",\"tag\":\"object").append(QByteArray::number(i)).append('"');
+    json.append(",\"trans\":{\"pos\":[").append(QByteArray::number(i * 10)).append(',')
+        .append(QByteArray::number(i % 500)).append(',').append(QByteArray::number(-i * 3))
+        .append("],\"rot\":[0,0,").append(QByteArray::number(i % 360)).append(",1000],\"scale\":[")
+        .append(QByteArray::number(500 + i % 1000)).append(",1000,1000]}}");
+  }
+  json.append("],\"gates\":[],\"version\":2,\"weather\":{\"cloud\":0.2,\"fog\":false,\"hour\":12.0}}");
+  return json;
+}
+
+qint64 BenchmarkTrack::median(QVector<qint64> values)
+{
+  std::sort(values.begin(), values.end());
+  return values.at(values.count() / 2);
+}
@@ -0,0 +1,17 @@
+#ifndef BENCHMARKTRACK_H
+#define BENCHMARKTRACK_H
+
+#include <QByteArray>
+#include <QVector>
+
+#include "prefabregistry.h"
+
+// Generated tracks the benchmarks run on, the same for every run and every benchmark
+namespace BenchmarkTrack
+{
+  PrefabRegistryPtr createRegistry();
+  QByteArray generateJson(const int objectCount);
+  qint64 median(QVector<qint64> values);
+}
+
+#endif // BENCHMARKTRACK_H
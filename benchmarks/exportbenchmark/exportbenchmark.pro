@@ -0,0 +1,6 @@
+include(../benchmark.pri)
+
+TARGET = exportbenchmark
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,66 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "benchmarktrack.h"
+#include "editorobject.h"
+#include "track.h"
+#include "velodataparser.h"
+
+// Saves a generated track with 50000 objects, once untouched and once with every object changed.
+// Usage: exportbenchmark [objectCount] [runs]
+
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  const QStringList arguments = app.arguments();
+  const int objectCount = arguments.count() > 1 ? arguments.at(1).toInt() : 50000;
+  const int runs = arguments.count() > 2 ? arguments.at(2).toInt() : 10;
+  QTextStream out(stdout);
+
+  const PrefabRegistryPtr registry = BenchmarkTrack::createRegistry();
+
+  TrackData trackData;
+  trackData.id = 1;
+  trackData.name = "Export benchmark";
+  trackData.assignedDatabase = DatabaseType::Custom;
+  trackData.value = BenchmarkTrack::generateJson(objectCount);
+
+  VeloDataParser loadParser;
+  Track* track = &loadParser.parseTrack(registry, trackData);
+
+  QVector<qint64> unchangedTimes;
+  QVector<qint64> changedTimes;
+  QByteArray exported;
+  for (int run = 0; run < runs; ++run) {
+    QElapsedTimer timer;
+    VeloDataParser parser;
+
+    timer.start();
+    exported = parser.exportToJson(*track);
+    unchangedTimes.append(timer.nsecsElapsed());
+
+    // A changed object is serialized field by field instead of being copied from the loaded json
+    foreach(EditorObject* object, track->getObjects())
+      object->setModified();
+
+    timer.start();
+    exported = parser.exportToJson(*track);
+    changedTimes.append(timer.nsecsElapsed());
+
+    // Like after a save in the editor, so the next run starts from an untouched track again
+    foreach(EditorObject* object, track->getObjects())
+      object->setModified(false);
+  }
+
+  // The second export of each run has to give back exactly what was loaded
+  const bool roundTrip = (exported == trackData.value);
+
+  out << "objects: " << track->getObjectCount() << ", json: " << trackData.value.size() << " bytes, runs: " << runs << endl;
+  out << "unchanged save: " << BenchmarkTrack::median(unchangedTimes) / 1000 << " us (median)" << endl;
+  out << "changed save:   " << BenchmarkTrack::median(changedTimes) / 1000 << " us (median)" << endl;
+  out << "round trip:     " << (roundTrip ? "identical" : "DIFFERENT") << endl;
+
+  delete track;
+  return roundTrip ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+include(../benchmark.pri)
+
+TARGET = filterbenchmark
+
+SOURCES += \
+    main.cpp
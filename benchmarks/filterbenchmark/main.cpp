@@ -0,0 +1,248 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "benchmarktrack.h"
+#include "editorobject.h"
+#include "filterplan.h"
+#include "scankernels.h"
+#include "searchfilter.h"
+#include "track.h"
+#include "trackstatistics.h"
+#include "velodataparser.h"
+
+// Times the compiled filter plan with its scan kernels against the per object, per filter
+// string comparisons NodeEditor::applyFilterToList() did before, on a generated track.
+// The plan is timed once serial, which is the kernel comparison, and once with the automatic
+// execution the editor uses, which runs on the thread pool above FilterPlan's parallel threshold.
+// Usage: filterbenchmark [objectCount] [runs]
+
+// The old applyFilterToList(), without the duplicate filter and working on SearchFilter instead of the widgets
+static void applyFilterToList(QVector<EditorObject*>& matchingItems, const QVector<SearchFilter>& filter, const FilterTypes filterType)
+{
+  bool match = false;
+  int rowCount = 1;
+  QString filterValue = "";
+  QString prefabValue = "";
+
+  foreach(const SearchFilter& searchFilter, filter) {
+    if (searchFilter.getType() != filterType)
+      continue;
+
+    filterValue = QString("%1").arg(searchFilter.getValue());
+
+    for (int item = 0; item < matchingItems.count(); ++item) {
+      match = false;
+
+      EditorObject* prefab = matchingItems.at(item);
+
+      if (filterType == FilterTypes::GateNo && !prefab->isGate()) {
+        matchingItems.removeOne(prefab);
+        item--;
+        continue;
+      }
+
+      switch (filterType) {
+      case FilterTypes::AnyPosition:
+      case FilterTypes::AnyScaling:
+        rowCount = 3;
+        break;
+      case FilterTypes::AnyRotation:
+        rowCount = 4;
+        break;
+      default:
+        rowCount = 1;
+      }
+      for (int row = 0; row < rowCount; ++row) {
+        switch (filterType) {
+        case FilterTypes::Object:
+          match = (int(prefab->getId()) == searchFilter.getValue());
+          continue;
+        case FilterTypes::AnyPosition:
+          prefabValue = QString("%1").arg(prefab->getPosition(row));
+          break;
+        case FilterTypes::PositionR:
+          prefabValue = QString("%1").arg(prefab->getPositionR());
+          break;
+        case FilterTypes::PositionG:
+          prefabValue = QString("%1").arg(prefab->getPositionG());
+          break;
+        case FilterTypes::PositionB:
+          prefabValue = QString("%1").arg(prefab->getPositionB());
+          break;
+        case FilterTypes::AnyRotation:
+          prefabValue = QString("%1").arg(prefab->getRotationVector(row));
+          break;
+        case FilterTypes::RotationW:
+          prefabValue = QString("%1").arg(prefab->getRotationW());
+          break;
+        case FilterTypes::RotationX:
+          prefabValue = QString("%1").arg(prefab->getRotationX());
+          break;
+        case FilterTypes::RotationY:
+          prefabValue = QString("%1").arg(prefab->getRotationY());
+          break;
+        case FilterTypes::RotationZ:
+          prefabValue = QString("%1").arg(prefab->getRotationZ());
+          break;
+        case FilterTypes::AnyScaling:
+          prefabValue = QString("%1").arg(prefab->getScaling(row));
+          break;
+        case FilterTypes::ScalingR:
+          prefabValue = QString("%1").arg(prefab->getScalingR());
+          break;
+        case FilterTypes::ScalingG:
+          prefabValue = QString("%1").arg(prefab->getScalingG());
+          break;
+        case FilterTypes::ScalingB:
+          prefabValue = QString("%1").arg(prefab->getScalingB());
+          break;
+        case FilterTypes::GateNo:
+          prefabValue = QString("%1").arg(prefab->getGateNo());
+          break;
+        case FilterTypes::IsOnSpline:
+          if (prefab->isOnSpline())
+            match = true;
+          continue;
+        default:
+          continue;
+        }
+
+        switch (searchFilter.getMethod()) {
+        case FilterMethods::Contains:
+          if (prefabValue.indexOf(filterValue) > -1)
+            match = true;
+          break;
+        case FilterMethods::Is:
+          if (prefabValue == filterValue)
+            match = true;
+          break;
+        case FilterMethods::SmallerThan:
+          if (prefabValue.toInt() < searchFilter.getValue())
+            match = true;
+          break;
+        case FilterMethods::BiggerThan:
+          if (prefabValue.toInt() > searchFilter.getValue())
+            match = true;
+          break;
+        }
+
+        if (match)
+          break;
+      }
+
+      if (!match) {
+        matchingItems.removeOne(prefab);
+        item--;
+      }
+    }
+  }
+}
+
+// The filters in the order the old search applied them
+static QVector<EditorObject*> legacySearch(const QVector<EditorObject*>& searchItems, const QVector<SearchFilter>& filterList)
+{
+  static const FilterTypes order[] = {
+    FilterTypes::Object, FilterTypes::PositionR, FilterTypes::PositionB, FilterTypes::PositionG, FilterTypes::AnyPosition,
+    FilterTypes::RotationW, FilterTypes::RotationX, FilterTypes::RotationY, FilterTypes::RotationZ, FilterTypes::AnyRotation,
+    FilterTypes::AnyScaling, FilterTypes::ScalingR, FilterTypes::ScalingB, FilterTypes::ScalingG, FilterTypes::GateNo,
+    FilterTypes::IsOnSpline
+  };
+
+  QVector<EditorObject*> matchList = searchItems;
+  for (const FilterTypes filterType : order) {
+    applyFilterToList(matchList, filterList, filterType);
+    if (matchList.isEmpty())
+      break;
+  }
+
+  return matchList;
+}
+
+struct Scenario
+{
+  const char* name;
+  QVector<SearchFilter> filters;
+};
+
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  const QStringList arguments = app.arguments();
+  const int objectCount = arguments.count() > 1 ? arguments.at(1).toInt() : 50000;
+  const int runs = arguments.count() > 2 ? arguments.at(2).toInt() : 10;
+  QTextStream out(stdout);
+
+  TrackData trackData;
+  trackData.id = 2;
+  trackData.name = "Filter benchmark";
+  trackData.assignedDatabase = DatabaseType::Custom;
+  trackData.value = BenchmarkTrack::generateJson(objectCount);
+
+  VeloDataParser parser;
+  Track* track = &parser.parseTrack(BenchmarkTrack::createRegistry(), trackData);
+  const QVector<EditorObject*> objects = track->getObjects();
+
+  QVector<Scenario> scenarios;
+  scenarios.append({ "prefab is 2", { SearchFilter(FilterTypes::Object, FilterMethods::Is, 2) } });
+  scenarios.append({ "position r > 250000", { SearchFilter(FilterTypes::PositionR, FilterMethods::BiggerThan, 250000) } });
+  scenarios.append({ "rotation y is 90", { SearchFilter(FilterTypes::RotationY, FilterMethods::Is, 90) } });
+  scenarios.append({ "any scaling < 600", { SearchFilter(FilterTypes::AnyScaling, FilterMethods::SmallerThan, 600) } });
+  scenarios.append({ "prefab 3, position g < 100, scaling r > 1200", {
+                       SearchFilter(FilterTypes::Object, FilterMethods::Is, 3),
+                       SearchFilter(FilterTypes::PositionG, FilterMethods::SmallerThan, 100),
+                       SearchFilter(FilterTypes::ScalingR, FilterMethods::BiggerThan, 1200) } });
+
+  out << "objects: " << objects.count() << ", runs: " << runs << ", kernels: " << ScanKernels::getInstructionSet() << endl;
+
+  bool allEqual = true;
+  foreach(const Scenario& scenario, scenarios) {
+    QVector<qint64> serialTimes;
+    QVector<qint64> parallelTimes;
+    QVector<qint64> legacyTimes;
+    QVector<EditorObject*> serialResult;
+    QVector<EditorObject*> parallelResult;
+    QVector<EditorObject*> legacyResult;
+    for (int run = 0; run < runs; ++run) {
+      QElapsedTimer timer;
+
+      // Building the plan is part of every search, so it is timed as well.
+      // Serial on one thread, so this compares the scan kernels alone against the old loops.
+      timer.start();
+      const TrackStatistics serialStatistics(track->getStore());
+      FilterPlan serialPlan(scenario.filters, &serialStatistics);
+      serialPlan.setExecution(FilterPlan::Serial);
+      serialResult = serialPlan.apply(objects);
+      serialTimes.append(timer.nsecsElapsed());
+
+      // What a search in the editor does, large tracks are split over the thread pool
+      timer.start();
+      const TrackStatistics parallelStatistics(track->getStore());
+      FilterPlan parallelPlan(scenario.filters, &parallelStatistics);
+      parallelPlan.setExecution(FilterPlan::Automatic);
+      parallelResult = parallelPlan.apply(objects);
+      parallelTimes.append(timer.nsecsElapsed());
+
+      timer.start();
+      legacyResult = legacySearch(objects, scenario.filters);
+      legacyTimes.append(timer.nsecsElapsed());
+    }
+
+    const bool equal = (serialResult == legacyResult) && (parallelResult == legacyResult);
+    allEqual = allEqual && equal;
+
+    const qint64 serialTime = BenchmarkTrack::median(serialTimes);
+    const qint64 parallelTime = BenchmarkTrack::median(parallelTimes);
+    const qint64 legacyTime = BenchmarkTrack::median(legacyTimes);
+    out << scenario.name << ": " << serialResult.count() << " matches, "
+        << "applyFilterToList " << legacyTime / 1000 << " us, "
+        << "plan serial " << serialTime / 1000 << " us ("
+        << QString::number(double(legacyTime) / qMax(serialTime, qint64(1)), 'f', 1) << "x), "
+        << "plan automatic " << parallelTime / 1000 << " us ("
+        << QString::number(double(legacyTime) / qMax(parallelTime, qint64(1)), 'f', 1) << "x)"
+        << (equal ? "" : ", RESULTS DIFFER") << endl;
+  }
+
+  delete track;
+  return allEqual ? 0 : 1;
+}
@@ -81,8 +81,7 @@ void JsonTreeViewItemDelegate::setEditorData(QWidget* editor, const QModelIndex&
   case EditorModelColumns::Name:
     comboBox = static_cast<QComboBox*>(editor);
     index = 0;
-    for (int i = 0; i < nodeEditor->getAllPrefabData().size(); ++i) {
-      PrefabData prefab = nodeEditor->getAllPrefabData().value(i);
+    foreach(PrefabData prefab, nodeEditor->getAllPrefabData()) {
       if (prefab.gate == selectedPrefab.gate) {
         QVariant var;
         var.setValue(prefab);
@@ -0,0 +1,221 @@
+#include "duplicatefinder.h"
+
+#include <cstring>
+
+#include "editorobject.h"
+
+namespace {
+
+int floorDiv(const int value, const int divisor)
+{
+  const int quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+int findRoot(QVector<int>& parents, int index)
+{
+  while (parents.at(index) != index) {
+    parents[index] = parents.at(parents.at(index));
+    index = parents.at(index);
+  }
+  return index;
+}
+
+}
+
+bool DuplicateFinder::Key::operator ==(const Key& b) const
+{
+  return std::memcmp(values, b.values, sizeof(values)) == 0;
+}
+
+uint qHash(const DuplicateFinder::Key& key, uint seed)
+{
+  return qHashBits(key.values, sizeof(key.values), seed);
+}
+
+DuplicateFinder::DuplicateFinder(const int tolerance) :
+  tolerance(qMax(0, tolerance))
+{
+}
+
+QVector<QVector<EditorObject*>> DuplicateFinder::findGroups(const QVector<EditorObject*>& objects) const
+{
+  if (tolerance == 0)
+    return findExactGroups(objects);
+
+  return findNearGroups(objects);
+}
+
+QSet<const EditorObject*> DuplicateFinder::findDuplicates(const QVector<EditorObject*>& objects) const
+{
+  QSet<const EditorObject*> duplicates;
+  foreach(const QVector<EditorObject*>& group, findGroups(objects)) {
+    foreach(const EditorObject* object, group)
+      duplicates.insert(object);
+  }
+
+  return duplicates;
+}
+
+int DuplicateFinder::getTolerance() const
+{
+  return tolerance;
+}
+
+void DuplicateFinder::setTolerance(const int value)
+{
+  tolerance = qMax(0, value);
+}
+
+bool DuplicateFinder::isCandidate(const EditorObject* object)
+{
+  return object != nullptr &&
+         !object->isRemoved() &&
+         !object->isSpline() &&
+         !object->isOnSpline() &&
+         !object->isSplineControl();
+}
+
+DuplicateFinder::Key DuplicateFinder::keyOf(const EditorObject* object)
+{
+  const TrackStore& store = object->getStore();
+  const int slot = object->getSlot();
+
+  Key key;
+  key.values[PrefabId] = int(store.getPrefabId(slot));
+  key.values[GateNo] = store.getValue(TrackStore::GateNo, slot);
+  key.values[Flags] = (store.hasFlag(slot, TrackStore::Start) ? 1 : 0) | (store.hasFlag(slot, TrackStore::Finish) ? 2 : 0);
+
+  // Position, rotation and scaling are the first ten columns of the store
+  for (int column = TrackStore::PositionR; column <= TrackStore::ScalingB; ++column)
+    key.values[FirstTransformation + column] = store.getValue(TrackStore::Column(column), slot);
+
+  return key;
+}
+
+bool DuplicateFinder::isNear(const Key& a, const Key& b) const
+{
+  if (a.values[PrefabId] != b.values[PrefabId] ||
+      a.values[GateNo] != b.values[GateNo] ||
+      a.values[Flags] != b.values[Flags])
+    return false;
+
+  for (int i = FirstTransformation; i < KeySize; ++i) {
+    if (qAbs(qint64(a.values[i]) - qint64(b.values[i])) > tolerance)
+      return false;
+  }
+
+  return true;
+}
+
+DuplicateFinder::Key DuplicateFinder::cellOf(const Key& key, const int dx, const int dy, const int dz) const
+{
+  // Objects within the tolerance are at most one cell apart on every axis
+  Key cell;
+  std::memset(cell.values, 0, sizeof(cell.values));
+  cell.values[PrefabId] = key.values[PrefabId];
+  cell.values[GateNo] = key.values[GateNo];
+  cell.values[Flags] = key.values[Flags];
+  cell.values[FirstTransformation + TrackStore::PositionR] = floorDiv(key.values[FirstTransformation + TrackStore::PositionR], tolerance) + dx;
+  cell.values[FirstTransformation + TrackStore::PositionG] = floorDiv(key.values[FirstTransformation + TrackStore::PositionG], tolerance) + dy;
+  cell.values[FirstTransformation + TrackStore::PositionB] = floorDiv(key.values[FirstTransformation + TrackStore::PositionB], tolerance) + dz;
+
+  return cell;
+}
+
+QVector<QVector<EditorObject*>> DuplicateFinder::findExactGroups(const QVector<EditorObject*>& objects) const
+{
+  QHash<Key, int> groupByKey;
+  groupByKey.reserve(objects.count());
+  QVector<QVector<EditorObject*>> groups;
+
+  foreach(EditorObject* object, objects) {
+    if (!isCandidate(object))
+      continue;
+
+    const Key key = keyOf(object);
+    QHash<Key, int>::const_iterator group = groupByKey.constFind(key);
+    if (group == groupByKey.constEnd()) {
+      groupByKey.insert(key, groups.count());
+      groups.append(QVector<EditorObject*>() << object);
+    } else {
+      groups[group.value()].append(object);
+    }
+  }
+
+  QVector<QVector<EditorObject*>> duplicateGroups;
+  foreach(const QVector<EditorObject*>& group, groups) {
+    if (group.count() > 1)
+      duplicateGroups.append(group);
+  }
+
+  return duplicateGroups;
+}
+
+QVector<QVector<EditorObject*>> DuplicateFinder::findNearGroups(const QVector<EditorObject*>& objects) const
+{
+  QVector<EditorObject*> candidates;
+  QVector<Key> keys;
+  candidates.reserve(objects.count());
+  keys.reserve(objects.count());
+  foreach(EditorObject* object, objects) {
+    if (!isCandidate(object))
+      continue;
+
+    candidates.append(object);
+    keys.append(keyOf(object));
+  }
+
+  QHash<Key, QVector<int>> cells;
+  for (int i = 0; i < candidates.count(); ++i)
+    cells[cellOf(keys.at(i), 0, 0, 0)].append(i);
+
+  // Near duplicates are chained, a is grouped with c if both are near b
+  QVector<int> parents(candidates.count());
+  for (int i = 0; i < parents.count(); ++i)
+    parents[i] = i;
+
+  for (int i = 0; i < candidates.count(); ++i) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dz = -1; dz <= 1; ++dz) {
+          QHash<Key, QVector<int>>::const_iterator cell = cells.constFind(cellOf(keys.at(i), dx, dy, dz));
+          if (cell == cells.constEnd())
+            continue;
+
+          foreach(const int j, cell.value()) {
+            if (j <= i || !isNear(keys.at(i), keys.at(j)))
+              continue;
+
+            const int rootI = findRoot(parents, i);
+            const int rootJ = findRoot(parents, j);
+            if (rootI != rootJ)
+              parents[qMax(rootI, rootJ)] = qMin(rootI, rootJ);
+          }
+        }
+      }
+    }
+  }
+
+  // Collect the groups in the order of their first object
+  QHash<int, int> groupByRoot;
+  QVector<QVector<EditorObject*>> groups;
+  for (int i = 0; i < candidates.count(); ++i) {
+    const int root = findRoot(parents, i);
+    QHash<int, int>::const_iterator group = groupByRoot.constFind(root);
+    if (group == groupByRoot.constEnd()) {
+      groupByRoot.insert(root, groups.count());
+      groups.append(QVector<EditorObject*>() << candidates.at(i));
+    } else {
+      groups[group.value()].append(candidates.at(i));
+    }
+  }
+
+  QVector<QVector<EditorObject*>> duplicateGroups;
+  foreach(const QVector<EditorObject*>& group, groups) {
+    if (group.count() > 1)
+      duplicateGroups.append(group);
+  }
+
+  return duplicateGroups;
+}
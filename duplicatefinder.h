@@ -0,0 +1,56 @@
+#ifndef DUPLICATEFINDER_H
+#define DUPLICATEFINDER_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+class EditorObject;
+
+// Groups objects that have the same prefab, transformation, gate number and start/finish flags.
+// Objects are hashed by those values, so the whole track is grouped in one pass.
+// With a tolerance above zero every value may differ by up to the tolerance; the objects are then
+// bucketed on a grid of that size and only compared to the objects of the neighbouring cells.
+// Spline objects and spline controls are never duplicates.
+class DuplicateFinder
+{
+public:
+  explicit DuplicateFinder(const int tolerance = 0);
+
+  QVector<QVector<EditorObject*>> findGroups(const QVector<EditorObject*>& objects) const;
+  QSet<const EditorObject*> findDuplicates(const QVector<EditorObject*>& objects) const;
+
+  int getTolerance() const;
+  void setTolerance(const int value);
+
+  static bool isCandidate(const EditorObject* object);
+
+private:
+  enum KeyValue {
+    PrefabId = 0,
+    GateNo,
+    Flags,
+    FirstTransformation,
+    KeySize = FirstTransformation + 10
+  };
+
+  struct Key
+  {
+    int values[KeySize];
+
+    bool operator ==(const Key& b) const;
+  };
+
+  friend uint qHash(const Key& key, uint seed);
+
+  int tolerance;
+
+  static Key keyOf(const EditorObject* object);
+  bool isNear(const Key& a, const Key& b) const;
+  Key cellOf(const Key& key, const int dx, const int dy, const int dz) const;
+
+  QVector<QVector<EditorObject*>> findExactGroups(const QVector<EditorObject*>& objects) const;
+  QVector<QVector<EditorObject*>> findNearGroups(const QVector<EditorObject*>& objects) const;
+};
+
+#endif // DUPLICATEFINDER_H
@@ -18,12 +18,12 @@ EditorManager::EditorManager(MainWindow& mainWindow, QTabWidget &widget) :
   setParent(&mainWindow);
 }
 
-void EditorManager::addEditor(const QVector<PrefabData>& prefabs, const TrackData trackData)
+void EditorManager::addEditor(const PrefabRegistryPtr& prefabs, const TrackData trackData, const QString& databaseFilename)
 {
   Track* track = nullptr;
   VeloDataParser parser;
   try {
-    track = &parser.parseTrack(prefabs, trackData);
+    track = &parser.parseTrack(prefabs, trackData, databaseFilename);
   } catch (VeloToolkitException& e) {
     e.Message();
     return;
@@ -321,6 +321,7 @@ void EditorManager::onNodeEditorContextMenuDeleteAction()
   QModelIndexList selectedIndexes = nodeEditor->getTreeView().selectionModel()->selectedIndexes();
   EditorModelItem* item = nullptr;
   EditorObject* object;
+  nodeEditor->beginNodeEdit();
   while(selectedIndexes.count() > 0) {
     // Take the last index and check if its valid
     item = nodeEditor->getEditorModel().itemFromIndex(selectedIndexes.takeLast());
@@ -333,6 +334,7 @@ void EditorManager::onNodeEditorContextMenuDeleteAction()
     // Delete the root node of the prefab
     nodeEditor->deleteNode(object->getIndex());
   }
+  nodeEditor->endNodeEdit();
 
   mainWindow.updateSearch();
   mainWindow.updateStatusBar();
@@ -347,6 +349,7 @@ void EditorManager::onNodeEditorContextMenuDublicateAction()
   // Go through each user selection, determinate the corresponding prefab and dublicate it
   EditorModelItem* item = nullptr;
   EditorObject* object;
+  nodeEditor->beginNodeEdit();
   foreach(QModelIndex index, nodeEditor->getTreeView().selectionModel()->selectedIndexes()) {
     // Take the last index and check if its valid
     item = nodeEditor->getEditorModel().itemFromIndex(index);
@@ -358,6 +361,7 @@ void EditorManager::onNodeEditorContextMenuDublicateAction()
 
     nodeEditor->duplicateObject(object);
   }
+  nodeEditor->endNodeEdit();
 
   // Update the status bar and filter markings, cause they could have changed
   mainWindow.updateSearch();
@@ -385,6 +389,7 @@ void EditorManager::onNodeEditorContextMenuMassDuplicateAction()
   // Go through each user selection, determinate the corresponding prefab and dublicate it
   EditorModelItem* item = nullptr;
   EditorObject* object;
+  nodeEditor->beginNodeEdit();
   foreach(QModelIndex index, nodeEditor->getTreeView().selectionModel()->selectedIndexes()) {
     // Take the last index and check if its valid
     item = nodeEditor->getEditorModel().itemFromIndex(index);
@@ -398,6 +403,7 @@ void EditorManager::onNodeEditorContextMenuMassDuplicateAction()
      nodeEditor->duplicateObject(object);
     }
   }
+  nodeEditor->endNodeEdit();
 
   // Update the status bar and filter markings, cause they could have changed
   mainWindow.updateSearch();
@@ -28,7 +28,7 @@ class EditorManager : public QObject
 public:
   EditorManager(MainWindow& mainWindow, QTabWidget& tabWidget);
 
-  void addEditor(const QVector<PrefabData>& prefabs, const TrackData trackData);
+  void addEditor(const PrefabRegistryPtr& prefabs, const TrackData trackData, const QString& databaseFilename = "");
   void closeEditor(const int index);
 
   NodeEditor* getEditor() const;
@@ -1,5 +1,9 @@
 #include "editormodel.h"
 
+#include <algorithm>
+
+#include "filterproxymodel.h"
+
 EditorModel::EditorModel(const Track* track, QObject* parent)
   : QAbstractItemModel(parent)
 {  
@@ -17,18 +21,135 @@ EditorModel::EditorModel(const Track* track, QObject* parent)
                                   settings.value("general/filterParentFontColorG", 128).toInt(),
                                   settings.value("general/filterParentFontColorB", 53).toInt());
 
-  rootItem = new EditorModelItem();
-
   loadTrack(track);
 }
 
 EditorModel::~EditorModel()
 {
-  while (!modelItems.isEmpty()) {
-    EditorModelItem* item = modelItems.takeLast();
-    delete item;
+}
+
+void EditorModel::beginEdit()
+{
+  editDepth++;
+}
+
+void EditorModel::endEdit()
+{
+  if (editDepth == 0 || --editDepth > 0)
+    return;
+
+  // Values first, while every row is still where the views expect it
+  for (QHash<const EditorModelItem*, QVector<int>>::const_iterator changed = changedRows.constBegin(); changed != changedRows.constEnd(); ++changed) {
+    const QModelIndex parentIndex = indexFromItem(changed.key());
+    foreach(const auto& range, toRanges(changed.value()))
+      emit dataChanged(index(range.first, 0, parentIndex), index(range.second, columnCount() - 1, parentIndex));
+  }
+  changedRows.clear();
+
+  // Appended rows are always behind the announced ones, so every parent gets one insert
+  foreach(const EditorModelItem* parent, announcedRowCounts.keys()) {
+    const int first = announcedRowCounts.value(parent);
+    const int last = parent->childCount() - 1;
+    if (last < first) {
+      announcedRowCounts.remove(parent);
+      continue;
+    }
+
+    beginInsertRows(indexFromItem(parent), first, last);
+    announcedRowCounts.remove(parent);
+    endInsertRows();
+  }
+
+  // Deepest parents first, a removed subtree may still hold removed rows of its own
+  QVector<QPair<int, EditorModelItem*>> removeOrder;
+  removeOrder.reserve(removedRows.count());
+  for (QHash<EditorModelItem*, QVector<int>>::const_iterator removed = removedRows.constBegin(); removed != removedRows.constEnd(); ++removed) {
+    int depth = 0;
+    for (const EditorModelItem* item = removed.key(); item != rootItem; item = item->getParentItem())
+      depth++;
+    removeOrder.append(qMakePair(depth, removed.key()));
+  }
+  std::sort(removeOrder.begin(), removeOrder.end(), [](const QPair<int, EditorModelItem*>& a, const QPair<int, EditorModelItem*>& b) {
+    return a.first > b.first;
+  });
+
+  foreach(const auto& entry, removeOrder) {
+    EditorModelItem* parent = entry.second;
+    const QModelIndex parentIndex = indexFromItem(parent);
+    const QVector<QPair<int, int>> ranges = toRanges(removedRows.value(parent));
+
+    // From the back, so the ranges in front keep their rows
+    for (int i = ranges.count() - 1; i >= 0; --i) {
+      beginRemoveRows(parentIndex, ranges.at(i).first, ranges.at(i).second);
+      parent->removeChildren(ranges.at(i).first, ranges.at(i).second - ranges.at(i).first + 1);
+      endRemoveRows();
+    }
+  }
+  removedRows.clear();
+}
+
+bool EditorModel::isEditing() const
+{
+  return editDepth > 0;
+}
+
+void EditorModel::appendItem(EditorModelItem* parent, EditorModelItem* item)
+{
+  if (!parent || !item)
+    return;
+
+  if (editDepth == 0) {
+    const int row = parent->childCount();
+    beginInsertRows(indexFromItem(parent), row, row);
+    parent->addChild(*item);
+    endInsertRows();
+    return;
+  }
+
+  // Below rows the views do not know yet, nothing has to be announced on its own
+  if (isAnnounced(parent) && !announcedRowCounts.contains(parent))
+    announcedRowCounts.insert(parent, parent->childCount());
+
+  parent->addChild(*item);
+}
+
+void EditorModel::removeItem(EditorModelItem* item)
+{
+  EditorModelItem* parent = item ? item->getParentItem() : nullptr;
+  if (!parent)
+    return;
+
+  const int row = item->childNumber();
+  if (editDepth == 0) {
+    beginRemoveRows(indexFromItem(parent), row, row);
+    parent->removeChild(row);
+    endRemoveRows();
+    return;
   }
-  delete rootItem;
+
+  // Rows the views never saw can go right away
+  if (!isAnnounced(item)) {
+    parent->removeChild(row);
+    return;
+  }
+
+  removedRows[parent].append(row);
+}
+
+EditorModelItem* EditorModel::createItem(EditorObject* object)
+{
+  return itemPool.create(*this, object);
+}
+
+void EditorModel::destroyItem(EditorModelItem* item)
+{
+  if (item == nullptr)
+    return;
+
+  while (item->childCount() > 0)
+    item->removeChild(item->childCount() - 1);
+
+  itemPool.destroy(item);
 }
 
 EditorModelItem* EditorModel::getModelItem(const QModelIndex& index) const
@@ -39,6 +160,24 @@ EditorModelItem* EditorModel::getModelItem(const QModelIndex& index) const
   return static_cast<EditorModelItem*>(index.internalPointer());
 }
 
+int EditorModel::getAnnouncedRowCount(const EditorModelItem* parent) const
+{
+  return announcedRowCounts.value(parent, parent->childCount());
+}
+
+bool EditorModel::isAnnounced(const EditorModelItem* item) const
+{
+  // Every row on the way up to the root has to be known to the views
+  while (item != rootItem) {
+    const EditorModelItem* parent = item->getParentItem();
+    if (!parent || item->childNumber() >= getAnnouncedRowCount(parent))
+      return false;
+    item = parent;
+  }
+
+  return true;
+}
+
 int EditorModel::columnCount(const QModelIndex& parent) const
 {
   Q_UNUSED(parent)
@@ -62,6 +201,9 @@ QVariant EditorModel::data(const QModelIndex& index, int role) const
     }
   }
 
+  if (role == USERROLE_FILTER)
+    return item && item->isInFilter();
+
   if (role != Qt::DisplayRole && role != Qt::EditRole)
     return QVariant();
 
@@ -166,24 +308,21 @@ bool EditorModel::isEditable(const QModelIndex& keyIndex) const
   if (!item || !item->hasObject())
     return false;
 
-  EditorObject* object =  item->getObject();
+  const EditorObject* object = item->getObject();
 
-  const PrefabData& prefab = object->getData();
+  // Start grids and spline parts are no editable prefabs
+  if (object->getId() > 0)
+    return object->isEditable();
 
-  if (NodeEditor::isStartGrid(prefab))
-    return false;
+  return !object->getStart() && !object->getFinish();
+}
 
-  if (prefab.id > 0) {
-    return ((prefab.name != "CtrlParent") &&
-            (prefab.name != "ControlCurve") &&
-            (prefab.name != "ControlPoint"));
-  } else if (item->getObject()->getStart()) {
-    return false;
-  } else if (item->getObject()->getFinish()) {
-    return false;
-  }
+QModelIndex EditorModel::indexFromItem(const EditorModelItem* item, const int column) const
+{
+  if (!item || item == rootItem)
+    return QModelIndex();
 
-  return true;
+  return createIndex(item->childNumber(), column, const_cast<EditorModelItem*>(item));
 }
 
 EditorModelItem* EditorModel::itemFromIndex(const QModelIndex index) const
@@ -221,55 +360,55 @@ QList<EditorModelItem*> EditorModel::itemsFromIndexList(const QModelIndexList in
 
 void EditorModel::loadTrack(const Track* track)
 {
-  while (!modelItems.isEmpty()) {
-    delete modelItems.takeLast();
-  }
-
-  if (!track)
-    return;
-
-  foreach(EditorObject* object, track->getObjects()) {
-    EditorModelItem* item = new EditorModelItem(object, this);
-    modelItems.append(item);
-    rootItem->addChild(*item);
-    if (object->getSplineControls().count() > 0) {
-      EditorModelItem* controlsRoot = new EditorModelItem();
-      controlsRoot->setText(tr("Controls"));
-      EditorModelItem* test = new EditorModelItem();
-      test->setText(tr("test"));
-      controlsRoot->addChild(*test);
-      modelItems.append(controlsRoot);
-      modelItems.append(test);
-      foreach(EditorObject* child, object->getSplineControls()) {
-        EditorModelItem* childItem = new EditorModelItem(child, controlsRoot);
-        modelItems.append(childItem);
-        controlsRoot->addChild(*childItem);
+  beginResetModel();
+
+  // Whatever an edit still had to report belongs to the old tree
+  announcedRowCounts.clear();
+  removedRows.clear();
+  changedRows.clear();
+
+  // Drop the old tree as a whole instead of item by item
+  itemPool.clear();
+  rootItem = createItem();
+
+  if (track) {
+    foreach(EditorObject* object, track->getObjects()) {
+      EditorModelItem* item = createItem(object);
+      rootItem->addChild(*item);
+      if (object->getSplineControls().count() > 0) {
+        EditorModelItem* controlsRoot = createItem();
+        controlsRoot->setText(tr("Controls"));
+        EditorModelItem* test = createItem();
+        test->setText(tr("test"));
+        controlsRoot->addChild(*test);
+        foreach(EditorObject* child, object->getSplineControls()) {
+          EditorModelItem* childItem = createItem(child);
+          controlsRoot->addChild(*childItem);
+        }
+        item->addChild(*controlsRoot);
       }
-      item->addChild(*controlsRoot);
-    }
-    if (object->getSplineObjects().count() > 0) {
-      EditorModelItem* objectsRoot = new EditorModelItem();
-      objectsRoot->setText(tr("Objects"));
-      modelItems.append(objectsRoot);
-      foreach(EditorObject* child, object->getSplineObjects()) {
-        EditorModelItem* childItem = new EditorModelItem(child, objectsRoot);
-        objectsRoot->addChild(*childItem);
-        modelItems.append(childItem);
+      if (object->getSplineObjects().count() > 0) {
+        EditorModelItem* objectsRoot = createItem();
+        objectsRoot->setText(tr("Objects"));
+        foreach(EditorObject* child, object->getSplineObjects()) {
+          EditorModelItem* childItem = createItem(child);
+          objectsRoot->addChild(*childItem);
+        }
+        item->addChild(*objectsRoot);
       }
-      item->addChild(*objectsRoot);
-    }
-    if (object->getSplineParents().count() > 0) {
-      EditorModelItem* objectParentsRoot = new EditorModelItem();
-      objectParentsRoot->setText(tr("Object Parents"));
-      modelItems.append(objectParentsRoot);
-      foreach(EditorObject* child, object->getSplineParents()) {
-        EditorModelItem* childItem = new EditorModelItem(child, objectParentsRoot);
-        objectParentsRoot->addChild(*childItem);
-        modelItems.append(childItem);
+      if (object->getSplineParents().count() > 0) {
+        EditorModelItem* objectParentsRoot = createItem();
+        objectParentsRoot->setText(tr("Object Parents"));
+        foreach(EditorObject* child, object->getSplineParents()) {
+          EditorModelItem* childItem = createItem(child);
+          objectParentsRoot->addChild(*childItem);
+        }
+        item->addChild(*objectParentsRoot);
       }
-      item->addChild(*objectParentsRoot);
     }
   }
+
+  endResetModel();
 }
 
 QModelIndex EditorModel::parent(const QModelIndex& index) const
@@ -279,10 +418,7 @@ QModelIndex EditorModel::parent(const QModelIndex& index) const
 
   EditorModelItem* parentItem = getModelItem(index)->getParentItem();
 
-  if (!parentItem || parentItem->getIndex() == rootItem->getIndex())
-    return QModelIndex();
-
-  return createIndex(parentItem->childNumber(), 0, parentItem);
+  return indexFromItem(parentItem);
 }
 
 EditorModelItem *EditorModel::getRootItem()
@@ -290,12 +426,41 @@ EditorModelItem *EditorModel::getRootItem()
   return rootItem;
 }
 
+void EditorModel::refreshItem(const EditorModelItem* item)
+{
+  if (!item || item == rootItem)
+    return;
+
+  reportChanged(item->getParentItem(), item->childNumber(), item->childNumber());
+}
+
+void EditorModel::reportChanged(const EditorModelItem* parent, const int first, const int last)
+{
+  if (!parent)
+    return;
+
+  if (editDepth == 0) {
+    const QModelIndex parentIndex = indexFromItem(parent);
+    emit dataChanged(index(first, 0, parentIndex), index(last, columnCount() - 1, parentIndex));
+    return;
+  }
+
+  // Rows the views do not know yet are read in full once they are announced
+  if (!isAnnounced(parent))
+    return;
+
+  const int lastAnnounced = qMin(last, getAnnouncedRowCount(parent) - 1);
+  QVector<int>& rows = changedRows[parent];
+  for (int row = first; row <= lastAnnounced; ++row)
+    rows.append(row);
+}
+
 int EditorModel::rowCount(const QModelIndex &parent) const
 {
   if (parent.column() > 0)
     return 0;
 
-  return getModelItem(parent)->childCount();
+  return getAnnouncedRowCount(getModelItem(parent));
 }
 
 bool EditorModel::setData(const QModelIndex& index, const QVariant& value, int role)
@@ -308,12 +473,52 @@ bool EditorModel::setData(const QModelIndex& index, const QVariant& value, int r
     return false;
 
   const bool success = object->setModelData(EditorModelColumns(index.column()), value);
-  if (success)
+  if (success && editDepth > 0)
+    reportChanged(object->getParentItem(), index.row(), index.row());
+  else if (success)
     emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
 
   return success;
 }
 
+void EditorModel::setFilterMarked(EditorModelItem* item, const bool marked)
+{
+  if (!item || !item->hasObject() || item->isFilterMarked() == marked)
+    return;
+
+  item->setFilterMarked(marked);
+
+  // A proxy checks the rows of a dataChanged again, so only the rows whose filter state can change are reported
+  refreshItem(item);
+
+  // Ancestors only change with the first marked descendant and the last one leaving, the counts grow towards the root
+  const int changedCount = marked ? 1 : 0;
+  for (const EditorModelItem* parentItem = item->getParentItem(); parentItem && parentItem != rootItem; parentItem = parentItem->getParentItem()) {
+    if (parentItem->getMarkedDescendantCount() != changedCount)
+      break;
+    refreshItem(parentItem);
+  }
+
+  refreshMarkedAncestors(item, changedCount);
+}
+
+void EditorModel::refreshMarkedAncestors(EditorModelItem* item, const int changedCount)
+{
+  // All children share the marked ancestors of their parent, so they change together as one range
+  const int childCount = item->childCount();
+  if (childCount == 0)
+    return;
+
+  EditorModelItem* firstChild = item->child(0);
+  if (firstChild->getMarkedAncestorCount() != changedCount)
+    return;
+
+  reportChanged(item, 0, childCount - 1);
+
+  for (int i = 0; i < childCount; ++i)
+    refreshMarkedAncestors(item->child(i), changedCount);
+}
+
 void EditorModel::setFilterBackgroundColor(const QBrush& value)
 {
   filterBackgroundColor = value;
@@ -335,3 +540,23 @@ void EditorModel::setFilterFontColor(const QBrush& value)
 }
 
 
+
+QVector<QPair<int, int>> EditorModel::toRanges(QVector<int> rows)
+{
+  QVector<QPair<int, int>> ranges;
+  if (rows.isEmpty())
+    return ranges;
+
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+  ranges.append(qMakePair(rows.first(), rows.first()));
+  for (int i = 1; i < rows.count(); ++i) {
+    if (rows.at(i) == ranges.last().second + 1)
+      ranges.last().second = rows.at(i);
+    else
+      ranges.append(qMakePair(rows.at(i), rows.at(i)));
+  }
+
+  return ranges;
+}
@@ -2,11 +2,14 @@
 #define EDITORMODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QPair>
 #include <QStandardItem>
 #include <QVector>
 
 #include "editormodelitem.h"
 #include "editorobject.h"
+#include "objectpool.h"
 #include "track.h"
 
 enum class EditorModelColumns {
@@ -37,6 +40,18 @@ public:
 
   void loadTrack(const Track* track);
 
+  // Changes between beginEdit() and the matching endEdit() are reported to the views in one go when the
+  // outermost edit ends, as few contiguous row ranges as possible. Appended rows stay hidden until then and
+  // removed rows stay in place, so every row the views know about keeps its number during the edit.
+  void                    beginEdit();
+  void                    endEdit();
+  bool                    isEditing() const;
+  void                    appendItem(EditorModelItem* parent, EditorModelItem* item);
+  void                    removeItem(EditorModelItem* item);
+
+  EditorModelItem*        createItem(EditorObject* object = nullptr);
+  void                    destroyItem(EditorModelItem* item);
+
   int                     columnCount(const QModelIndex& parent = QModelIndex()) const override;
   QVariant                data(const QModelIndex& index, int role) const override;
   Qt::ItemFlags           flags(const QModelIndex& index) const override;
@@ -47,28 +62,46 @@ public:
   QVariant                headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
   QModelIndex             index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
   bool                    isEditable(const QModelIndex& keyIndex) const;
+  QModelIndex             indexFromItem(const EditorModelItem* item, const int column = 0) const;
   EditorModelItem*        itemFromIndex(const QModelIndex index) const;
   QList<EditorModelItem*> itemsFromIndex(const QModelIndex index) const;
   QList<EditorModelItem*> itemsFromIndexList(const QModelIndexList indexList) const;
   QModelIndex             parent(const QModelIndex& index) const override;
   EditorModelItem*        getRootItem();
+  void                    refreshItem(const EditorModelItem* item);
   int                     rowCount(const QModelIndex& parent = QModelIndex()) const override;
   bool                    setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
   void                    setFilterFontColor(const QBrush& value);
+  void                    setFilterMarked(EditorModelItem* item, const bool marked);
   void                    setFilterBackgroundColor(const QBrush& value);
   void                    setFilterContentBackgroundColor(const QBrush& value);
   void                    setFilterContentFontColor(const QBrush& value);
 
 private:
-  EditorModelItem* rootItem;
-  QVector<EditorModelItem*> modelItems;
+  // All items of the model, they are freed in one go when the model is reset or destroyed
+  ObjectPool<EditorModelItem> itemPool;
+  EditorModelItem* rootItem = nullptr;
 
   QBrush filterFontColor = QBrush(QColor(Qt::black));
   QBrush filterBackgroundColor = QBrush(QColor(254, 203, 137));
   QBrush filterContentBackgroundColor = QBrush(QColor(192, 192, 192));
   QBrush filterContentFontColor = QBrush(Qt::black);
 
+  int editDepth = 0;
+
+  // Row counts the views know about, for parents that got rows appended during the edit
+  QHash<const EditorModelItem*, int> announcedRowCounts;
+  // Rows that were removed or changed during the edit, by their parent
+  QHash<EditorModelItem*, QVector<int>> removedRows;
+  QHash<const EditorModelItem*, QVector<int>> changedRows;
+
   EditorModelItem* getModelItem(const QModelIndex& index) const;
+  int getAnnouncedRowCount(const EditorModelItem* parent) const;
+  bool isAnnounced(const EditorModelItem* item) const;
+  void refreshMarkedAncestors(EditorModelItem* item, const int changedCount);
+  void reportChanged(const EditorModelItem* parent, const int first, const int last);
+
+  static QVector<QPair<int, int>> toRanges(QVector<int> rows);
 };
 
 #endif // EDITORMODEL_H
@@ -1,15 +1,20 @@
 #include "editormodelitem.h"
 
-EditorModelItem::EditorModelItem(EditorObject* object, QObject* parent)
+EditorModelItem::EditorModelItem(EditorModel& model, EditorObject* object) :
+  model(&model)
 {
   setObject(object);
-  setParent(parent);
 }
 
 void EditorModelItem::addChild(EditorModelItem& child)
 {
   child.setParentItem(this);
+  child.row = children.count();
   children.append(&child);
+
+  // The new subtree sits below our marks and its own marks count for us and everything above
+  child.addMarkedAncestors(markedAncestorCount + (isFilterMarked() ? 1 : 0) - child.markedAncestorCount);
+  addMarkedDescendants(child.getMarkedCount());
 }
 
 EditorModelItem* EditorModelItem::child(const int number)
@@ -27,22 +32,46 @@ int EditorModelItem::childCount() const
 
 int EditorModelItem::childNumber() const
 {
-  int number = 0;
-  if (parentItem)
-    number = children.indexOf(const_cast<EditorModelItem*>(this));
-
-  return number;
+  return row;
 }
 
 void EditorModelItem::removeChild(const int number, const bool deleteChild)
 {
-  if (number > children.count())
+  if (number < 0 || number >= children.count())
     return;
 
-  if (!deleteChild)
+  EditorModelItem* child = children.takeAt(number);
+  addMarkedDescendants(-child->getMarkedCount());
+  child->addMarkedAncestors(-child->markedAncestorCount);
+  child->parentItem = nullptr;
+  child->row = 0;
+
+  // Every sibling behind the removed child moves up one row
+  for (int i = number; i < children.count(); ++i)
+    children[i]->row = i;
+
+  if (deleteChild)
+    model->destroyItem(child);
+}
+
+void EditorModelItem::removeChildren(const int first, const int count)
+{
+  if (first < 0 || count <= 0 || first + count > children.count())
     return;
 
-  delete children.takeAt(number);
+  for (int i = first; i < first + count; ++i) {
+    EditorModelItem* child = children.at(i);
+    addMarkedDescendants(-child->getMarkedCount());
+    child->addMarkedAncestors(-child->markedAncestorCount);
+    child->parentItem = nullptr;
+    child->row = 0;
+    model->destroyItem(child);
+  }
+  children.remove(first, count);
+
+  // The siblings behind the range are renumbered once instead of once per child
+  for (int i = first; i < children.count(); ++i)
+    children[i]->row = i;
 }
 
 QVariant EditorModelItem::getModelData(const EditorModelColumns column)
@@ -135,7 +164,6 @@ void EditorModelItem::setParentItem(EditorModelItem* parent)
     parentItem->removeChild(childNumber(), false);
 
   parentItem = parent;
-  setParent(parent);
 }
 
 bool EditorModelItem::hasObject() const
@@ -169,12 +197,7 @@ void EditorModelItem::setText(const QString& text)
 
 QModelIndex EditorModelItem::getIndex() const
 {
-  return index;
-}
-
-void EditorModelItem::setIndex(const QModelIndex& index)
-{
-  this->index = index;
+  return model->indexFromItem(this);
 }
 
 bool EditorModelItem::isModified() const
@@ -203,8 +226,54 @@ bool EditorModelItem::isFilterMarked() const
 
 void EditorModelItem::setFilterMarked(const bool marked)
 {
-  if (!hasObject())
+  if (!hasObject() || object->isFilterMarked() == marked)
     return;
 
   object->setFilterMarked(marked);
+
+  const int delta = marked ? 1 : -1;
+  for (int i = 0; i < children.count(); ++i)
+    children[i]->addMarkedAncestors(delta);
+  if (parentItem != nullptr)
+    parentItem->addMarkedDescendants(delta);
+}
+
+int EditorModelItem::getMarkedAncestorCount() const
+{
+  return markedAncestorCount;
+}
+
+int EditorModelItem::getMarkedDescendantCount() const
+{
+  return markedDescendantCount;
+}
+
+bool EditorModelItem::isInFilter() const
+{
+  // Marked items are shown with their whole content and the path that leads to them
+  return markedAncestorCount > 0 || markedDescendantCount > 0 || isFilterMarked();
+}
+
+int EditorModelItem::getMarkedCount() const
+{
+  return markedDescendantCount + (isFilterMarked() ? 1 : 0);
+}
+
+void EditorModelItem::addMarkedAncestors(const int delta)
+{
+  if (delta == 0)
+    return;
+
+  markedAncestorCount += delta;
+  for (int i = 0; i < children.count(); ++i)
+    children[i]->addMarkedAncestors(delta);
+}
+
+void EditorModelItem::addMarkedDescendants(const int delta)
+{
+  if (delta == 0)
+    return;
+
+  for (EditorModelItem* item = this; item != nullptr; item = item->parentItem)
+    item->markedDescendantCount += delta;
 }
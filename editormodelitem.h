@@ -6,21 +6,22 @@
 #include "editormodel.h"
 #include "editorobject.h"
 
+class EditorModel;
 class EditorObject;
 enum class EditorModelColumns;
 
-class EditorModelItem : public QObject
+// Items are created and destroyed by their model, which keeps them in a pool
+class EditorModelItem
 {
-  Q_OBJECT
-
 public:
-  explicit EditorModelItem(EditorObject* object = nullptr, QObject* parent = nullptr);
+  explicit EditorModelItem(EditorModel& model, EditorObject* object = nullptr);
 
   void addChild(EditorModelItem& child);
   EditorModelItem* child(const int number);
   int childCount() const;
   int childNumber() const;
   void removeChild(const int number, const bool deleteChild = true);
+  void removeChildren(const int first, const int count);
 
   QVariant getModelData(const EditorModelColumns column);
   bool setModelData(const EditorModelColumns column, const QVariant& value);
@@ -37,7 +38,6 @@ public:
   void setText(const QString& value);
 
   QModelIndex getIndex() const;
-  void setIndex(const QModelIndex& index);
 
   bool isModified() const;
   void setModified(bool modified);
@@ -45,14 +45,28 @@ public:
   bool isFilterMarked() const;
   void setFilterMarked(const bool marked);
 
-signals:
+  // Marks above and below this item, so the filter does not have to walk the tree for every row
+  int getMarkedAncestorCount() const;
+  int getMarkedDescendantCount() const;
+  bool isInFilter() const;
 
 private:
-  QModelIndex index;
+  EditorModel* model;
+
+  // The position within the parent, kept up to date by the parent on every add and remove
+  int row = 0;
   QString text;
   EditorObject* object = nullptr;
   QVector<EditorModelItem*> children;
   EditorModelItem* parentItem = nullptr;
+
+  // Kept up to date on every mark change, add and remove
+  int markedAncestorCount = 0;
+  int markedDescendantCount = 0;
+
+  int getMarkedCount() const;
+  void addMarkedAncestors(const int delta);
+  void addMarkedDescendants(const int delta);
 };
 
 #endif // EDITORMODELITEM_H
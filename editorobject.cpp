@@ -1,56 +1,38 @@
 #include "editorobject.h"
 
-EditorObject::EditorObject(NodeEditor* parentEditor)
+EditorObject::EditorObject(TrackStore& store, NodeEditor* parentEditor) :
+  store(&store),
+  slot(store.allocate(this))
 {
   editor = parentEditor;
 }
 
 EditorObject::EditorObject(const EditorObject& b)
-  : QObject(b.parent())
+  : store(b.store),
+    slot(b.store->allocate(this))
 {
   if (&b == this)
     return;
 
-  prefab = b.prefab;
+  // A copy is a new object, it is neither modified nor removed like its source might be
+  store->copySlot(b.slot, slot);
+  store->setFlag(slot, TrackStore::Modified, false);
+  store->setFlag(slot, TrackStore::Removed, false);
 
   editor = b.editor;
 
-  positionR = b.positionR;
-  positionG = b.positionG;
-  positionB = b.positionB;
+  jsonLayout = b.jsonLayout;
+  unknownMembers = b.unknownMembers;
 
-  rotationW = b.rotationW;
-  rotationX = b.rotationX;
-  rotationY = b.rotationY;
-  rotationZ = b.rotationZ;
-
-  scalingR = b.scalingR;
-  scalingG = b.scalingG;
-  scalingB = b.scalingB;
-
-  gateNo = b.gateNo;
-  finish = b.finish;
-  start = b.start;
-
-  isMoving = b.isMoving;
-  speed = b.speed;
-
-  filterMarked = b.filterMarked;
-
-  foreach(EditorObject* obj, b.splineControls) {
-    splineControls.append(new EditorObject(*obj));
-  }
-  foreach(EditorObject* obj, b.splineObjects) {
-    splineObjects.append(new EditorObject(*obj));
-  }
-  foreach(EditorObject* obj, b.splineParents) {
-    splineParents.append(new EditorObject(*obj));
-  }
+  cloneSplineChildren(b);
 }
 
 EditorObject::~EditorObject()
 {
-  qDebug() << "Editor Object destroyed";
+  // The spline children belong to their spline
+  destroySplineChildren();
+
+  store->release(slot);
 }
 
 EditorObject& EditorObject::operator =(const EditorObject& b)
@@ -58,66 +40,85 @@ EditorObject& EditorObject::operator =(const EditorObject& b)
   if (&b == this)
     return *this;
 
-  prefab = b.prefab;
+  // Objects are only assigned within the same track, so the children can be cloned into its pool
+  Q_ASSERT(store == b.store);
+  store->copySlot(b.slot, slot);
 
   editor = b.editor;
 
-  positionR = b.positionR;
-  positionG = b.positionG;
-  positionB = b.positionB;
-
-  rotationW = b.rotationW;
-  rotationX = b.rotationX;
-  rotationY = b.rotationY;
-  rotationZ = b.rotationZ;
+  jsonLayout = b.jsonLayout;
+  unknownMembers = b.unknownMembers;
 
-  scalingR = b.scalingR;
-  scalingG = b.scalingG;
-  scalingB = b.scalingB;
+  destroySplineChildren();
+  cloneSplineChildren(b);
 
-  gateNo = b.gateNo;
-  finish = b.finish;
-  start = b.start;
-
-  isMoving = b.isMoving;
-  speed = b.speed;
+  return *this;
+}
 
-  modified = b.modified;
-  filterMarked = b.filterMarked;
+bool EditorObject::operator==(const EditorObject &b) {
+  return (getId() == b.getId()) &&
+         (getGateNo() == b.getGateNo()) &&
+         (getStart() == b.getStart()) &&
+         (getFinish() == b.getFinish()) &&
+         (getPositionR() == b.getPositionR()) &&
+         (getPositionG() == b.getPositionG()) &&
+         (getPositionB() == b.getPositionB()) &&
+         (getRotationW() == b.getRotationW()) &&
+         (getRotationX() == b.getRotationX()) &&
+         (getRotationY() == b.getRotationY()) &&
+         (getRotationZ() == b.getRotationZ()) &&
+         (getScalingR() == b.getScalingR()) &&
+         (getScalingG() == b.getScalingG()) &&
+         (getScalingB() == b.getScalingB()) &&
+         (splineControls.count() == b.splineControls.count()) &&
+         (splineObjects.count() == b.splineObjects.count()) &&
+         (splineParents.count() == b.splineParents.count());
+}
 
+void EditorObject::cloneSplineChildren(const EditorObject& b)
+{
+  // The links point to the children of b, they are moved over to the clones
+  QHash<const EditorObject*, EditorObject*> clones;
   foreach(EditorObject* obj, b.splineControls) {
-    splineControls.append(new EditorObject(*obj));
+    splineControls.append(store->cloneObject(*obj));
+    splineControls.last()->setParentObject(this);
   }
   foreach(EditorObject* obj, b.splineObjects) {
-    splineObjects.append(new EditorObject(*obj));
+    splineObjects.append(store->cloneObject(*obj));
+    splineObjects.last()->setParentObject(this);
+    clones.insert(obj, splineObjects.last());
   }
   foreach(EditorObject* obj, b.splineParents) {
-    splineParents.append(new EditorObject(*obj));
+    splineParents.append(store->cloneObject(*obj));
+    splineParents.last()->setParentObject(this);
+    clones.insert(obj, splineParents.last());
   }
 
-  return *this;
+  splineLinks = b.splineLinks;
+  splineGroupCount = b.splineGroupCount;
+  for (int i = 0; i < splineLinks.count(); ++i) {
+    SplineLink& link = splineLinks[i];
+    link.object = clones.value(link.object, nullptr);
+    link.parent = clones.value(link.parent, nullptr);
+  }
 }
 
-bool EditorObject::operator==(const EditorObject &b) {
-  return (prefab.id == b.prefab.id) &&
-         (gateNo == b.gateNo) &&
-         (start == b.start) &&
-         (finish == b.finish) &&
-         (positionR == b.positionR) &&
-         (positionG == b.positionG) &&
-         (positionB == b.positionB) &&
-         (rotationW == b.rotationW) &&
-         (rotationX == b.rotationX) &&
-         (rotationY == b.rotationY) &&
-         (rotationZ == b.rotationZ) &&
-         (scalingR == b.scalingR) &&
-         (scalingG == b.scalingG) &&
-         (scalingB == b.scalingB) &&
-         (isMoving == b.isMoving) &&
-         (speed == b.speed) &&
-         (splineControls.count() == b.splineControls.count()) &&
-         (splineObjects.count() == b.splineObjects.count()) &&
-         (splineParents.count() == b.splineParents.count());
+void EditorObject::destroySplineChildren()
+{
+  foreach(EditorObject* object, splineControls)
+    store->destroyObject(object);
+
+  foreach(EditorObject* object, splineObjects)
+    store->destroyObject(object);
+
+  foreach(EditorObject* object, splineParents)
+    store->destroyObject(object);
+
+  splineControls.clear();
+  splineObjects.clear();
+  splineParents.clear();
+  splineLinks.clear();
+  splineGroupCount = 0;
 }
 
 bool EditorObject::applyScaling(const QVector3D& values)
@@ -125,51 +126,44 @@ bool EditorObject::applyScaling(const QVector3D& values)
   if (values == QVector3D(1, 1, 1))
     return false;
 
-  setScaling(0, int(std::round(scalingR * values.x())));
-  setScaling(1, int(std::round(scalingG * values.y())));
-  setScaling(2, int(std::round(scalingB * values.z())));
+  setScaling(0, int(std::round(getScalingR() * values.x())));
+  setScaling(1, int(std::round(getScalingG() * values.y())));
+  setScaling(2, int(std::round(getScalingB() * values.z())));
 
   return true;
 }
 
 void EditorObject::reset()
 {
-  prefab = PrefabData();
+  store->setPrefab(slot, PrefabData());
 
   index = QModelIndex();
 
-  positionR = 0;
-  positionG = 0;
-  positionB = 0;
+  for (int column = 0; column < TrackStore::ColumnCount; ++column)
+    setColumnValue(TrackStore::Column(column), 0);
+  setColumnValue(TrackStore::RotationW, 1000);
+  setColumnValue(TrackStore::GateNo, -1);
 
-  rotationW = 1000;
-  rotationX = 0;
-  rotationY = 0;
-  rotationZ = 0;
-
-  scalingR = 0;
-  scalingG = 0;
-  scalingB = 0;
-
-  gateNo = -1;
-  finish = false;
-  start = false;
+  store->setFlag(slot, TrackStore::Finish, false);
+  store->setFlag(slot, TrackStore::Start, false);
 }
 
 
 PrefabData EditorObject::getData() const
 {
-  return prefab;
+  const PrefabData* prefab = store->getPrefab(slot);
+  return prefab != nullptr ? *prefab : PrefabData();
 }
 
 unsigned int EditorObject::getId() const
 {
-  return prefab.id;
+  return store->getPrefabId(slot);
 }
 
 QString EditorObject::getName() const
 {
-  return prefab.name;
+  const PrefabData* prefab = store->getPrefab(slot);
+  return prefab != nullptr ? prefab->name : QString();
 }
 
 QModelIndex EditorObject::getIndex() const
@@ -187,7 +181,7 @@ bool EditorObject::setData(const PrefabData& value)
   if (!isEditable())
     return false;
 
-  prefab = value;
+  store->setPrefab(slot, value);
 
   // Update the model if set
   setModified();
@@ -198,9 +192,9 @@ bool EditorObject::setData(const PrefabData& value)
 int EditorObject::getPosition(const int row) const
 {
   switch (row) {
-  case 0: return positionR;
-  case 1: return positionG;
-  case 2: return positionB;
+  case 0: return getColumnValue(TrackStore::PositionR);
+  case 1: return getColumnValue(TrackStore::PositionG);
+  case 2: return getColumnValue(TrackStore::PositionB);
   }
   return 0;
 }
@@ -208,9 +202,9 @@ int EditorObject::getPosition(const int row) const
 void EditorObject::setPosition(const int row, const int value)
 {
   switch (row) {
-  case 0: positionR = value; break;
-  case 1: positionG = value; break;
-  case 2: positionB = value; break;
+  case 0: setColumnValue(TrackStore::PositionR, value); break;
+  case 1: setColumnValue(TrackStore::PositionG, value); break;
+  case 2: setColumnValue(TrackStore::PositionB, value); break;
   }
 
   // Update the model if set
@@ -219,9 +213,9 @@ void EditorObject::setPosition(const int row, const int value)
 
 void EditorObject::setPosition(const int r, const int g, const int b)
 {
-  positionR = r;
-  positionG = g;
-  positionB = b;
+  setColumnValue(TrackStore::PositionR, r);
+  setColumnValue(TrackStore::PositionG, g);
+  setColumnValue(TrackStore::PositionB, b);
 
   // Update the model if setsetModified();
 }
@@ -229,10 +223,10 @@ void EditorObject::setPosition(const int r, const int g, const int b)
 int EditorObject::getRotationVector(const int row) const
 {
   switch (row) {
-  case 0: return rotationW;
-  case 1: return rotationX;
-  case 2: return rotationY;
-  case 3: return rotationZ;
+  case 0: return getColumnValue(TrackStore::RotationW);
+  case 1: return getColumnValue(TrackStore::RotationX);
+  case 2: return getColumnValue(TrackStore::RotationY);
+  case 3: return getColumnValue(TrackStore::RotationZ);
   }
   return 0;
 }
@@ -240,10 +234,10 @@ int EditorObject::getRotationVector(const int row) const
 void EditorObject::setRotation(const int row, const int value)
 {
   switch (row) {
-  case 0: rotationW = value; break;
-  case 1: rotationX = value; break;
-  case 2: rotationY = value; break;
-  case 3: rotationZ = value; break;
+  case 0: setColumnValue(TrackStore::RotationW, value); break;
+  case 1: setColumnValue(TrackStore::RotationX, value); break;
+  case 2: setColumnValue(TrackStore::RotationY, value); break;
+  case 3: setColumnValue(TrackStore::RotationZ, value); break;
   }
 
   // Update the model if set
@@ -252,10 +246,10 @@ void EditorObject::setRotation(const int row, const int value)
 
 void EditorObject::setRotation(const int w, const int x, const int y, const int z)
 {
-  rotationW = w;
-  rotationX = x;
-  rotationY = y;
-  rotationZ = z;
+  setColumnValue(TrackStore::RotationW, w);
+  setColumnValue(TrackStore::RotationX, x);
+  setColumnValue(TrackStore::RotationY, y);
+  setColumnValue(TrackStore::RotationZ, z);
 
   // Update the model if set
   setModified();
@@ -272,9 +266,9 @@ void EditorObject::setRotation(const QQuaternion& rotation)
 int EditorObject::getScaling(const int row) const
 {
   switch (row) {
-  case 0: return scalingR;
-  case 1: return scalingG;
-  case 2: return scalingB;
+  case 0: return getColumnValue(TrackStore::ScalingR);
+  case 1: return getColumnValue(TrackStore::ScalingG);
+  case 2: return getColumnValue(TrackStore::ScalingB);
   }
   return 1;
 }
@@ -282,9 +276,9 @@ int EditorObject::getScaling(const int row) const
 bool EditorObject::setScaling(const int row, const int value)
 {
   switch (row) {
-  case 0: scalingR = value; break;
-  case 1: scalingG = value; break;
-  case 2: scalingB = value; break;
+  case 0: setColumnValue(TrackStore::ScalingR, value); break;
+  case 1: setColumnValue(TrackStore::ScalingG, value); break;
+  case 2: setColumnValue(TrackStore::ScalingB, value); break;
   }
 
   // Update the model if set
@@ -295,9 +289,9 @@ bool EditorObject::setScaling(const int row, const int value)
 
 bool EditorObject::setScaling(const int r, const int g, const int b)
 {
-  scalingR = r;
-  scalingG = g;
-  scalingB = b;
+  setColumnValue(TrackStore::ScalingR, r);
+  setColumnValue(TrackStore::ScalingG, g);
+  setColumnValue(TrackStore::ScalingB, b);
 
   // Update the model if set
   setModified();
@@ -307,7 +301,7 @@ bool EditorObject::setScaling(const int r, const int g, const int b)
 
 int EditorObject::getPositionR() const
 {
-  return positionR;
+  return getColumnValue(TrackStore::PositionR);
 }
 
 void EditorObject::setPositionR(const int value)
@@ -322,7 +316,7 @@ void EditorObject::setPositionR(const double value)
 
 int EditorObject::getPositionG() const
 {
-  return positionG;
+  return getColumnValue(TrackStore::PositionG);
 }
 
 void EditorObject::setPositionG(int value)
@@ -337,7 +331,7 @@ void EditorObject::setPositionG(const double value)
 
 int EditorObject::getPositionB() const
 {
-  return positionB;
+  return getColumnValue(TrackStore::PositionB);
 }
 
 void EditorObject::setPositionB(const int value)
@@ -352,7 +346,7 @@ void EditorObject::setPositionB(const double value)
 
 QVector3D EditorObject::getPositionVector() const
 {
-  return QVector3D(positionR, positionG, positionB);
+  return QVector3D(getPositionR(), getPositionG(), getPositionB());
 }
 
 void EditorObject::setPosition(const QVector3D& position)
@@ -364,7 +358,7 @@ void EditorObject::setPosition(const QVector3D& position)
 
 int EditorObject::getRotationW() const
 {
-  return rotationW;
+  return getColumnValue(TrackStore::RotationW);
 }
 
 void EditorObject::setRotationW(const int value)
@@ -379,7 +373,7 @@ void EditorObject::setRotationW(const double value)
 
 int EditorObject::getRotationX() const
 {
-  return rotationX;
+  return getColumnValue(TrackStore::RotationX);
 }
 
 void EditorObject::setRotationX(const int value)
@@ -394,7 +388,7 @@ void EditorObject::setRotationX(const double value)
 
 int EditorObject::getRotationY() const
 {
-  return rotationY;
+  return getColumnValue(TrackStore::RotationY);
 }
 
 void EditorObject::setRotationY(const int value)
@@ -409,7 +403,7 @@ void EditorObject::setRotationY(const double value)
 
 int EditorObject::getRotationZ() const
 {
-  return rotationZ;
+  return getColumnValue(TrackStore::RotationZ);
 }
 
 void EditorObject::setRotationZ(const int value)
@@ -424,15 +418,15 @@ void EditorObject::setRotationZ(const double value)
 
 QQuaternion EditorObject::getRotationQuaterion() const
 {
-  return QQuaternion(float(rotationW) / 1000,
-                     float(rotationX) / 1000,
-                     float(rotationY) / 1000,
-                     float(rotationZ) / 1000);
+  return QQuaternion(float(getRotationW()) / 1000,
+                     float(getRotationX()) / 1000,
+                     float(getRotationY()) / 1000,
+                     float(getRotationZ()) / 1000);
 }
 
 QVector4D EditorObject::getRotationVector() const
 {
-  return QVector4D(rotationW, rotationX, rotationY, rotationZ);
+  return QVector4D(getRotationW(), getRotationX(), getRotationY(), getRotationZ());
 }
 
 void EditorObject::setRotation(const QVector4D& rotation)
@@ -445,7 +439,7 @@ void EditorObject::setRotation(const QVector4D& rotation)
 
 int EditorObject::getScalingR() const
 {
-  return scalingR;
+  return getColumnValue(TrackStore::ScalingR);
 }
 
 void EditorObject::setScalingR(const int value)
@@ -460,7 +454,7 @@ void EditorObject::setScalingR(const double value)
 
 int EditorObject::getScalingG() const
 {
-  return scalingG;
+  return getColumnValue(TrackStore::ScalingG);
 }
 
 void EditorObject::setScalingG(const int value)
@@ -475,7 +469,7 @@ void EditorObject::setScalingG(const double value)
 
 int EditorObject::getScalingB() const
 {
-  return scalingB;
+  return getColumnValue(TrackStore::ScalingB);
 }
 
 void EditorObject::setScalingB(const int value)
@@ -490,7 +484,7 @@ void EditorObject::setScalingB(const double value)
 
 QVector3D EditorObject::getScalingVector() const
 {
-  return QVector3D(scalingR, scalingB, scalingG);
+  return QVector3D(getScalingR(), getScalingB(), getScalingG());
 }
 
 void EditorObject::setScaling(const QVector3D& scaling)
@@ -502,20 +496,20 @@ void EditorObject::setScaling(const QVector3D& scaling)
 
 bool EditorObject::isGate() const
 {
-  return prefab.gate && gateNo > 0;
+  return store->hasCapability(slot, PrefabRegistry::Gate) && (getGateNo() > 0);
 }
 
 int EditorObject::getGateNo() const
 {
-  return gateNo;
+  return getColumnValue(TrackStore::GateNo);
 }
 
 void EditorObject::setGateNo(const int value, const bool updateGateOrder)
 {
   // Update gate order
-  const uint oldGateNo = uint(gateNo);
+  const uint oldGateNo = uint(getGateNo());
 
-  gateNo = value;
+  setColumnValue(TrackStore::GateNo, value);
 
   // Update the model if set
   setModified();
@@ -527,16 +521,19 @@ void EditorObject::setGateNo(const int value, const bool updateGateOrder)
 
 bool EditorObject::getFinish() const
 {
-  return finish;
+  return store->hasFlag(slot, TrackStore::Finish);
 }
 
 void EditorObject::setFinish(const bool value)
 {
   // Prevent disabling a finish
-  if (finish && !value)
+  if (getFinish() && !value)
     return;
 
-  finish = value;
+  if (getFinish() != value)
+    setModified();
+
+  store->setFlag(slot, TrackStore::Finish, value);
 
   if (editor == nullptr || !value)
     return;
@@ -546,12 +543,15 @@ void EditorObject::setFinish(const bool value)
 
 bool EditorObject::getStart() const
 {
-  return start;
+  return store->hasFlag(slot, TrackStore::Start);
 }
 
 void EditorObject::setStart(const bool value)
 {
-  start = value;
+  if (getStart() != value)
+    setModified();
+
+  store->setFlag(slot, TrackStore::Start, value);
 
   if (editor == nullptr || !value)
     return;
@@ -569,39 +569,74 @@ QVector<EditorObject*>& EditorObject::getSplineObjects()
   return splineObjects;
 }
 
-bool EditorObject::getIsMoving() const
+QVector<SplineLink>& EditorObject::getSplineLinks()
 {
-  return isMoving;
+  return splineLinks;
 }
 
-void EditorObject::setIsMoving(bool value)
+int EditorObject::getSplineGroupCount() const
 {
-  isMoving = value;
+  return splineGroupCount;
 }
 
-char EditorObject::getSpeed() const
+void EditorObject::setSplineGroupCount(const int value)
 {
-  return speed;
+  splineGroupCount = value;
 }
 
-void EditorObject::setSpeed(char value)
+void EditorObject::addSplineCopy(EditorObject* source, EditorObject* copy)
 {
-  speed = value;
+  copy->setParentObject(this);
+
+  if (splineControls.contains(source)) {
+    splineControls.append(copy);
+    return;
+  }
+
+  const bool isSplineObject = splineObjects.contains(source);
+  if (isSplineObject)
+    splineObjects.append(copy);
+  else if (splineParents.contains(source))
+    splineParents.append(copy);
+  else
+    return;
+
+  // The copy gets a link of its own, with the other side left out
+  SplineLink link;
+  foreach(const SplineLink& sourceLink, splineLinks) {
+    if (sourceLink.object == source || sourceLink.parent == source) {
+      link = sourceLink;
+      break;
+    }
+  }
+  link.object = isSplineObject ? copy : nullptr;
+  link.parent = isSplineObject ? nullptr : copy;
+  link.jsonLayout = isSplineObject ? SplineLink::HasJoKey : SplineLink::HasCtrlpKey;
+  splineLinks.append(link);
 }
 
-int EditorObject::getSplineIndex() const
+void EditorObject::removeSplineChild(EditorObject* child)
 {
-  return splineIndex;
+  splineControls.removeOne(child);
+  splineObjects.removeOne(child);
+  splineParents.removeOne(child);
+
+  for (int i = 0; i < splineLinks.count(); ++i) {
+    if (splineLinks[i].object == child)
+      splineLinks[i].object = nullptr;
+    if (splineLinks[i].parent == child)
+      splineLinks[i].parent = nullptr;
+  }
 }
 
-void EditorObject::setSplineIndex(const int value)
+QVector<JsonSourceMember>& EditorObject::getUnknownMembers()
 {
-  splineIndex = value;
+  return unknownMembers;
 }
 
 bool EditorObject::isValid() const
 {
-  return (prefab.id > 0);
+  return (getId() > 0);
 }
 
 EditorModelItem* EditorObject::getParentModelItem() const
@@ -626,14 +661,14 @@ void EditorObject::setParentObject(EditorObject* parent)
 
 bool EditorObject::isModified() const
 {
-  return modified;
+  return store->hasFlag(slot, TrackStore::Modified);
 }
 
 void EditorObject::setModified(bool value)
 {
-  modified = value;
+  store->setFlag(slot, TrackStore::Modified, value);
 
-  if (modified == true)
+  if (value == true)
     return;
 
   foreach(EditorObject* object, splineObjects) {
@@ -651,12 +686,104 @@ void EditorObject::setModified(bool value)
 
 bool EditorObject::isFilterMarked() const
 {
-  return filterMarked;
+  return store->hasFlag(slot, TrackStore::FilterMarked);
 }
 
 void EditorObject::setFilterMarked(const bool value)
 {
-  filterMarked = value;
+  store->setFlag(slot, TrackStore::FilterMarked, value);
+}
+
+bool EditorObject::hasJsonLayoutFlag(const JsonLayoutFlag flag) const
+{
+  return (jsonLayout & flag) != 0;
+}
+
+void EditorObject::setJsonLayoutFlag(const JsonLayoutFlag flag, const bool value)
+{
+  if (value)
+    jsonLayout |= flag;
+  else
+    jsonLayout &= ~uint(flag);
+}
+
+bool EditorObject::hasSourceSpan() const
+{
+  return sourceOffset >= 0;
+}
+
+int EditorObject::getSourceOffset() const
+{
+  return sourceOffset;
+}
+
+int EditorObject::getSourceLength() const
+{
+  return sourceLength;
+}
+
+void EditorObject::setSourceSpan(const int offset, const int length)
+{
+  sourceOffset = offset;
+  sourceLength = length;
+}
+
+void EditorObject::clearSourceSpan()
+{
+  sourceOffset = -1;
+  sourceLength = 0;
+}
+
+bool EditorObject::isUnchangedSinceExport()
+{
+  if (isModified() || !hasSourceSpan())
+    return false;
+
+  foreach(EditorObject* object, splineControls) {
+    if (!object->isUnchangedSinceExport())
+      return false;
+  }
+
+  foreach(EditorObject* object, splineObjects) {
+    if (!object->isUnchangedSinceExport())
+      return false;
+  }
+
+  foreach(EditorObject* object, splineParents) {
+    if (!object->isUnchangedSinceExport())
+      return false;
+  }
+
+  return true;
+}
+
+bool EditorObject::isRemoved() const
+{
+  return store->hasFlag(slot, TrackStore::Removed);
+}
+
+void EditorObject::setRemoved(const bool value)
+{
+  store->setFlag(slot, TrackStore::Removed, value);
+
+  foreach(EditorObject* object, splineControls)
+    object->setRemoved(value);
+
+  foreach(EditorObject* object, splineObjects)
+    object->setRemoved(value);
+
+  foreach(EditorObject* object, splineParents)
+    object->setRemoved(value);
+}
+
+TrackStore& EditorObject::getStore() const
+{
+  return *store;
+}
+
+int EditorObject::getSlot() const
+{
+  return slot;
 }
 
 QVector<EditorObject*>& EditorObject::getSplineParents()
@@ -666,17 +793,12 @@ QVector<EditorObject*>& EditorObject::getSplineParents()
 
 bool EditorObject::isEditable() const
 {
-  if (prefab.name == "CtrlParent" ||
-      prefab.name == "ControlCurve" ||
-      prefab.name == "ControlPoint" ||
-      prefab.name == "DefaultStartGrid" ||
-      prefab.name == "DefaultKDRAStartGrid" ||
-      prefab.name == "DR1StartGrid" ||
-      prefab.name == "PolyStartGrid" ||
-      prefab.name == "MicroStartGrid")
-    return false;
+  return store->hasCapability(slot, PrefabRegistry::Editable);
+}
 
-  return true;
+bool EditorObject::isStartGrid() const
+{
+  return store->hasCapability(slot, PrefabRegistry::StartGrid);
 }
 
 bool EditorObject::isOnSpline() const
@@ -686,10 +808,10 @@ bool EditorObject::isOnSpline() const
 
 bool EditorObject::isSplineControl() const
 {
-  return (prefab.id == 345);
+  return store->hasCapability(slot, PrefabRegistry::SplineControl);
 }
 
 bool EditorObject::isSpline() const
 {
-  return (prefab.name == "ControlCurve");
+  return store->hasCapability(slot, PrefabRegistry::Spline);
 }
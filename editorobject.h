@@ -2,6 +2,7 @@
 #define PREFAB_H
 
 #include <cmath>
+#include <QHash>
 #include <QModelIndex>
 #include <QObject>
 #include <QVector>
@@ -9,19 +10,70 @@
 #include "editormodel.h"
 #include "editormodelitem.h"
 #include "nodeeditor.h"
+#include "trackstore.h"
 #include "velodb.h"
 
 class EditorModelItem;
 
 enum class EditorModelColumns;
 class NodeEditor;
+class EditorObject;
 
-class EditorObject : public QObject
+// A member of the track json the editor does not know. Only its place in the json the track was loaded
+// from (or last exported to) is kept, so a save writes it back unchanged.
+struct JsonSourceMember
 {
-  Q_OBJECT
+  // The json object the member was found in
+  enum Scope : quint8 {
+    Root = 0,
+    Object = 1,
+    Transform = 2,
+    Curve = 3,
+    SplineGroup = 4,
+    SplineLink = 5,
+    SplineLinkTransform = 6
+  };
+
+  quint8 scope = Object;
+  // The spline group or link the member belongs to, -1 for the other scopes
+  int scopeIndex = -1;
+  int keyOffset = 0;
+  int keyLength = 0;
+  int valueOffset = 0;
+  int valueLength = 0;
+};
+
+// One lojb entry of a spline, the object that sits on the spline and its control parent.
+// Either side may be missing or an empty slot, the link is still written back as it was.
+struct SplineLink
+{
+  enum JsonLayoutFlag : quint8 {
+    HasCtrlpKey = 0x01,
+    HasJoKey = 0x02
+  };
+
+  int group = 0;
+  int index = 0;
+  bool isMoving = false;
+  char speed = 0;
+  quint8 jsonLayout = 0;
+  EditorObject* object = nullptr;
+  EditorObject* parent = nullptr;
+};
 
+class EditorObject
+{
 public:
-  explicit EditorObject(NodeEditor* parentEditor = nullptr);
+  // Remembers how the object was stored in the track json, so we write it back the same way
+  enum JsonLayoutFlag {
+    HasCurveKey = 0x01,
+    HasFinishKey = 0x02,
+    HasGateKey = 0x04,
+    HasStartKey = 0x08,
+    StoredInGates = 0x10
+  };
+
+  explicit EditorObject(TrackStore& store, NodeEditor* parentEditor = nullptr);
   EditorObject(const EditorObject& b);
   ~EditorObject();
 
@@ -117,6 +169,7 @@ public:
   bool isEditable() const;
 
   bool isSpline() const;
+  bool isStartGrid() const;
   bool isOnSpline() const;
   bool isSplineControl() const;
 
@@ -124,14 +177,17 @@ public:
   QVector<EditorObject*>& getSplineObjects();
   QVector<EditorObject*>& getSplineParents();
 
-  bool getIsMoving() const;
-  void setIsMoving(bool value);
+  // The lojb entries of the curve, in the order they are written back
+  QVector<SplineLink>& getSplineLinks();
+  int getSplineGroupCount() const;
+  void setSplineGroupCount(const int value);
 
-  char getSpeed() const;
-  void setSpeed(char value);
+  // Adds a copy of a spline child next to its source, a copied link keeps the group, index and movement
+  void addSplineCopy(EditorObject* source, EditorObject* copy);
+  // Takes a child off the spline, its lojb slot stays as an empty one
+  void removeSplineChild(EditorObject* child);
 
-  int getSplineIndex() const;
-  void setSplineIndex(const int value);
+  QVector<JsonSourceMember>& getUnknownMembers();
 
   bool isValid() const;  
 
@@ -147,44 +203,55 @@ public:
   bool isFilterMarked() const;
   void setFilterMarked(const bool value = true);
 
+  bool hasJsonLayoutFlag(const JsonLayoutFlag flag) const;
+  void setJsonLayoutFlag(const JsonLayoutFlag flag, const bool value = true);
+
+  bool hasSourceSpan() const;
+  int getSourceOffset() const;
+  int getSourceLength() const;
+  void setSourceSpan(const int offset, const int length);
+  void clearSourceSpan();
+  bool isUnchangedSinceExport();
+
+  bool isRemoved() const;
+  void setRemoved(const bool value = true);
+
+  TrackStore& getStore() const;
+  int getSlot() const;
+
 private:
-  bool modified = false;
-  bool filterMarked = false;
+  // Prefab, transformation, gate number and flags live in the columns of the track store
+  TrackStore* store;
+  int slot;
 
   const int modifiedRole = 20000;
 
-  PrefabData prefab = PrefabData();
-
   QVector<EditorObject*> splineControls;
   QVector<EditorObject*> splineObjects;
   QVector<EditorObject*> splineParents;
 
-  EditorObject* parentObject;
-  EditorModelItem* parentModelItem;
+  EditorObject* parentObject = nullptr;
+  EditorModelItem* parentModelItem = nullptr;
 
   NodeEditor* editor = nullptr;
   QModelIndex index;
 
-  int positionR = 0;
-  int positionG = 0;
-  int positionB = 0;
+  QVector<SplineLink> splineLinks;
+  int splineGroupCount = 0;
 
-  int rotationW = 1000;
-  int rotationX = 0;
-  int rotationY = 0;
-  int rotationZ = 0;
+  uint jsonLayout = 0;
+  QVector<JsonSourceMember> unknownMembers;
 
-  int scalingR = 0;
-  int scalingG = 0;
-  int scalingB = 0;
+  // Where the object was found in the json it was loaded from (or last exported to).
+  // This is not copied along with the object, a copy always has to be encoded.
+  int sourceOffset = -1;
+  int sourceLength = 0;
 
-  int gateNo = -1;
-  bool finish = false;
-  bool start = false;
+  void cloneSplineChildren(const EditorObject& b);
+  void destroySplineChildren();
 
-  bool isMoving = false;
-  char speed = 0;
-  int splineIndex = 0;
+  inline int getColumnValue(const TrackStore::Column column) const { return store->getValue(column, slot); }
+  inline void setColumnValue(const TrackStore::Column column, const int value) { store->setValue(column, slot, value); }
 };
 
 #endif // PREFAB_H
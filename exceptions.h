@@ -32,6 +32,13 @@ public:
     VeloToolkitException("The track is invalid") {}
 };
 
+class InvalidSearchQueryException : public VeloToolkitException
+{
+public:
+  InvalidSearchQueryException(const QString reason, const int position) :
+    VeloToolkitException(QString("Invalid search query at position %1: %2").arg(position + 1).arg(reason)) {}
+};
+
 class NoDatabasesFileNameException : public VeloToolkitException
 {
 public:
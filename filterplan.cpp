@@ -0,0 +1,538 @@
+#include "filterplan.h"
+
+#include <algorithm>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "duplicatefinder.h"
+#include "editorobject.h"
+#include "trackstatistics.h"
+
+FilterPlan::FilterPlan(const QVector<SearchFilter>& filterList, const TrackStatistics* statistics) :
+  FilterPlan(SearchQuery(filterList), statistics)
+{
+}
+
+FilterPlan::FilterPlan(const SearchQuery& query, const TrackStatistics* statistics)
+{
+  if (!query.isEmpty())
+    root = compile(query, query.getRoot(), statistics);
+
+  findScannablePredicates();
+}
+
+int FilterPlan::compile(const SearchQuery& query, const int index, const TrackStatistics* statistics)
+{
+  const SearchQuery::Node& queryNode = query.getNode(index);
+
+  switch (queryNode.type) {
+  case SearchQuery::Filter:
+    return compileFilter(queryNode.filter, statistics);
+
+  case SearchQuery::Not: {
+    const int child = compile(query, queryNode.children.first(), statistics);
+    if (child < 0)
+      return -1;
+
+    if (nodes.at(child).type == Not)
+      return nodes.at(child).children.first();
+
+    Node node;
+    node.type = Not;
+    node.predicate = -1;
+    node.children.append(child);
+    node.selectivity = 1.0 - nodes.at(child).selectivity;
+    node.cost = nodes.at(child).cost;
+    return addNode(node);
+  }
+
+  case SearchQuery::And:
+  case SearchQuery::Or: {
+    Node node;
+    node.type = (queryNode.type == SearchQuery::And) ? All : Any;
+    node.predicate = -1;
+
+    foreach(const int queryChild, queryNode.children) {
+      const int child = compile(query, queryChild, statistics);
+      if (child < 0)
+        continue;
+
+      // Nested groups of the same kind are merged, so all of their children get ordered together
+      if (nodes.at(child).type == node.type)
+        node.children += nodes.at(child).children;
+      else
+        node.children.append(child);
+    }
+
+    if (node.children.isEmpty())
+      return -1;
+
+    if (node.children.count() == 1)
+      return node.children.first();
+
+    orderChildren(node);
+    return addNode(node);
+  }
+  }
+
+  return -1;
+}
+
+int FilterPlan::compileFilter(const SearchFilter& filter, const TrackStatistics* statistics)
+{
+  // Custom indexes are added by the node editor, they are no predicate
+  if (filter.getType() == FilterTypes::CustomIndex)
+    return -1;
+
+  if (filter.getType() == FilterTypes::Query) {
+    const SearchQueryPtr query = filter.getQuery();
+    if (query.isNull() || query->isEmpty())
+      return -1;
+    return compile(*query, query->getRoot(), statistics);
+  }
+
+  Predicate predicate;
+  predicate.kind = Column;
+  predicate.method = filter.getMethod();
+  predicate.value = filter.getValue();
+  predicate.firstColumn = TrackStore::PositionR;
+  predicate.columnCount = 1;
+  predicate.textLength = toDecimal(predicate.value, predicate.text);
+  predicate.scannable = false;
+
+  switch (filter.getType()) {
+  case FilterTypes::Object:
+    // The prefab is always compared by its id
+    predicate.kind = Prefab;
+    predicate.method = FilterMethods::Is;
+    break;
+  case FilterTypes::AnyPosition: predicate.firstColumn = TrackStore::PositionR; predicate.columnCount = 3; break;
+  case FilterTypes::PositionR: predicate.firstColumn = TrackStore::PositionR; break;
+  case FilterTypes::PositionG: predicate.firstColumn = TrackStore::PositionG; break;
+  case FilterTypes::PositionB: predicate.firstColumn = TrackStore::PositionB; break;
+  case FilterTypes::AnyRotation: predicate.firstColumn = TrackStore::RotationW; predicate.columnCount = 4; break;
+  case FilterTypes::RotationW: predicate.firstColumn = TrackStore::RotationW; break;
+  case FilterTypes::RotationX: predicate.firstColumn = TrackStore::RotationX; break;
+  case FilterTypes::RotationY: predicate.firstColumn = TrackStore::RotationY; break;
+  case FilterTypes::RotationZ: predicate.firstColumn = TrackStore::RotationZ; break;
+  case FilterTypes::AnyScaling: predicate.firstColumn = TrackStore::ScalingR; predicate.columnCount = 3; break;
+  case FilterTypes::ScalingR: predicate.firstColumn = TrackStore::ScalingR; break;
+  case FilterTypes::ScalingG: predicate.firstColumn = TrackStore::ScalingG; break;
+  case FilterTypes::ScalingB: predicate.firstColumn = TrackStore::ScalingB; break;
+  case FilterTypes::GateNo:
+    predicate.kind = Gate;
+    predicate.firstColumn = TrackStore::GateNo;
+    break;
+  case FilterTypes::IsOnSpline:
+    predicate.kind = OnSpline;
+    break;
+  case FilterTypes::IsDublicate:
+    // The value is the tolerance, zero only finds exact duplicates
+    predicate.kind = Duplicate;
+    hasDuplicatePredicates = true;
+    break;
+  default:
+    return -1;
+  }
+
+  // Reads the model of the object, which is only allowed from the gui thread
+  if (predicate.kind == OnSpline)
+    isThreadSafe = false;
+
+  predicates.append(predicate);
+
+  Node node;
+  node.type = Leaf;
+  node.predicate = predicates.count() - 1;
+  node.selectivity = estimateSelectivity(predicate, statistics);
+  node.cost = estimateCost(predicate);
+  return addNode(node);
+}
+
+int FilterPlan::addNode(const Node& node)
+{
+  nodes.append(node);
+  return nodes.count() - 1;
+}
+
+void FilterPlan::orderChildren(Node& node) const
+{
+  // An All is decided by the first child that misses, an Any by the first that matches.
+  // The children that decide it most often for the least work go first.
+  const bool all = (node.type == All);
+  auto score = [&](const int index) {
+    const Node& child = nodes.at(index);
+    const double decides = all ? 1.0 - child.selectivity : child.selectivity;
+    return child.cost / qMax(decides, 0.000001);
+  };
+
+  std::stable_sort(node.children.begin(), node.children.end(), [&](const int a, const int b) {
+    return score(a) < score(b);
+  });
+
+  // The children are taken as independent of each other
+  double undecided = 1.0;
+  node.cost = 0.0;
+  foreach(const int index, node.children) {
+    const Node& child = nodes.at(index);
+    node.cost += undecided * child.cost;
+    undecided *= all ? child.selectivity : 1.0 - child.selectivity;
+  }
+  node.selectivity = all ? undecided : 1.0 - undecided;
+}
+
+void FilterPlan::findScannablePredicates()
+{
+  if (root < 0)
+    return;
+
+  // Only predicates that have to match on their own can be applied to whole columns up front
+  QVector<int> required;
+  if (nodes.at(root).type == All)
+    required = nodes.at(root).children;
+  else
+    required.append(root);
+
+  foreach(const int index, required) {
+    const Node& node = nodes.at(index);
+    if (node.type != Leaf)
+      continue;
+
+    Predicate& predicate = predicates[node.predicate];
+    predicate.scannable = (predicate.kind == Prefab || predicate.kind == Gate || predicate.kind == Column) &&
+                          predicate.method != FilterMethods::Contains;
+    hasScannablePredicates |= predicate.scannable;
+  }
+}
+
+double FilterPlan::estimateSelectivity(const Predicate& predicate, const TrackStatistics* statistics)
+{
+  switch (predicate.kind) {
+  case Prefab:
+    return statistics != nullptr ? statistics->estimatePrefab(uint(predicate.value)) : 0.05;
+  case Gate:
+    return statistics != nullptr ? statistics->estimateGate(predicate.method, predicate.value) : 0.5 * guessSelectivity(predicate.method);
+  case Column: {
+    // Any* filters miss only if all of their columns miss
+    double misses = 1.0;
+    for (int column = predicate.firstColumn; column < predicate.firstColumn + predicate.columnCount; ++column) {
+      misses *= 1.0 - (statistics != nullptr ?
+                        statistics->estimateColumn(TrackStore::Column(column), predicate.method, predicate.value) :
+                        guessSelectivity(predicate.method));
+    }
+    return 1.0 - misses;
+  }
+  case OnSpline:
+    return 0.5;
+  case Duplicate:
+    return 0.1;
+  }
+
+  return 0.5;
+}
+
+double FilterPlan::estimateCost(const Predicate& predicate)
+{
+  switch (predicate.kind) {
+  case Prefab: return 1.0;
+  case Gate: return 2.0;
+  case Column: return predicate.columnCount * (predicate.method == FilterMethods::Contains ? 4.0 : 1.0);
+  case OnSpline: return 20.0;
+  case Duplicate: return 2.0;
+  }
+
+  return 1.0;
+}
+
+double FilterPlan::guessSelectivity(const FilterMethods method)
+{
+  // Without statistics: single values are rare, ranges cut about half
+  switch (method) {
+  case FilterMethods::Is: return 0.1;
+  case FilterMethods::Contains: return 0.3;
+  default: return 0.5;
+  }
+}
+
+bool FilterPlan::isEmpty() const
+{
+  return root < 0;
+}
+
+bool FilterPlan::accepts(const EditorObject* object) const
+{
+  return isEmpty() || matchesNode(root, object, nullptr, false);
+}
+
+bool FilterPlan::dependsOnAllObjects() const
+{
+  return hasDuplicatePredicates;
+}
+
+FilterPlan::Execution FilterPlan::getExecution() const
+{
+  return execution;
+}
+
+void FilterPlan::setExecution(const Execution value)
+{
+  execution = value;
+}
+
+QBitArray FilterPlan::evaluate(const QVector<EditorObject*>& objects) const
+{
+  QBitArray result(objects.count(), isEmpty());
+  if (objects.isEmpty() || isEmpty())
+    return result;
+
+  const bool parallel = runParallel(objects.count());
+
+  // Scanning the columns of the whole store only pays off if we are looking at a good part of it
+  const TrackStore& store = objects.first()->getStore();
+  bool scanColumns = hasScannablePredicates && objects.count() >= store.getSlotCount() / 8;
+  for (int i = 1; i < objects.count() && scanColumns; ++i)
+    scanColumns = (&objects.at(i)->getStore() == &store);
+
+  QVector<quint64> selection;
+  if (scanColumns) {
+    const int wordCount = ScanKernels::getWordCount(store.getSlotCount());
+    selection.fill(~quint64(0), wordCount);
+
+    if (parallel) {
+      // Every chunk writes its own words of the selection
+      QVector<Chunk> wordChunks = createChunks(wordCount, chunkSize / 64);
+      QtConcurrent::blockingMap(wordChunks, [&](const Chunk& chunk) {
+        scanWords(store, chunk.begin, chunk.end, selection.data());
+      });
+    } else {
+      scanWords(store, 0, wordCount, selection.data());
+    }
+  }
+
+  // Duplicates are found among all searched objects up front, the chunks only look them up
+  QVector<QSet<const EditorObject*>> duplicates(predicates.count());
+  for (int p = 0; p < predicates.count(); ++p) {
+    if (predicates.at(p).kind == Duplicate)
+      duplicates[p] = DuplicateFinder(predicates.at(p).value).findDuplicates(objects);
+  }
+
+  // One byte per object, so the chunks never share anything they write to
+  QVector<quint8> matched(objects.count(), 0);
+  const quint64* scanned = scanColumns ? selection.constData() : nullptr;
+
+  if (parallel) {
+    QVector<Chunk> objectChunks = createChunks(objects.count(), chunkSize);
+    QtConcurrent::blockingMap(objectChunks, [&](const Chunk& chunk) {
+      evaluateRange(objects, chunk, scanned, duplicates, matched.data());
+    });
+  } else {
+    evaluateRange(objects, { 0, objects.count() }, scanned, duplicates, matched.data());
+  }
+
+  for (int i = 0; i < objects.count(); ++i) {
+    if (matched.at(i))
+      result.setBit(i);
+  }
+
+  return result;
+}
+
+bool FilterPlan::runParallel(const int count) const
+{
+  if (!isThreadSafe || execution == Serial)
+    return false;
+
+  if (QThreadPool::globalInstance()->maxThreadCount() < 2)
+    return false;
+
+  return execution == Parallel || count >= parallelThreshold;
+}
+
+QVector<FilterPlan::Chunk> FilterPlan::createChunks(const int count, const int size)
+{
+  QVector<Chunk> chunks;
+  chunks.reserve(count / size + 1);
+  for (int begin = 0; begin < count; begin += size)
+    chunks.append({ begin, qMin(count, begin + size) });
+
+  return chunks;
+}
+
+void FilterPlan::scanWords(const TrackStore& store, const int firstWord, const int lastWord, quint64* selection) const
+{
+  const int firstSlot = firstWord * 64;
+  const int slotCount = qMin(store.getSlotCount(), lastWord * 64) - firstSlot;
+  const int wordCount = lastWord - firstWord;
+  quint64* words = selection + firstWord;
+
+  QVector<quint64> lanes(wordCount);
+
+  foreach(const Predicate& predicate, predicates) {
+    if (!predicate.scannable)
+      continue;
+
+    const ScanKernels::Compare columnCompare = toCompare(predicate.method);
+
+    switch (predicate.kind) {
+    case Prefab:
+      ScanKernels::compare(reinterpret_cast<const int*>(store.getPrefabIds()) + firstSlot, slotCount, ScanKernels::Equal, predicate.value, words, ScanKernels::And);
+      break;
+    case Gate:
+      ScanKernels::testBits(store.getCapabilities() + firstSlot, slotCount, PrefabRegistry::Gate, words, ScanKernels::And);
+      ScanKernels::compare(store.getColumn(TrackStore::GateNo) + firstSlot, slotCount, ScanKernels::Greater, 0, words, ScanKernels::And);
+      ScanKernels::compare(store.getColumn(TrackStore::GateNo) + firstSlot, slotCount, columnCompare, predicate.value, words, ScanKernels::And);
+      break;
+    case Column:
+      // The Any* filters match if one of their columns does
+      if (predicate.columnCount == 1) {
+        ScanKernels::compare(store.getColumn(predicate.firstColumn) + firstSlot, slotCount, columnCompare, predicate.value, words, ScanKernels::And);
+        break;
+      }
+      for (int column = 0; column < predicate.columnCount; ++column)
+        ScanKernels::compare(store.getColumn(TrackStore::Column(predicate.firstColumn + column)) + firstSlot, slotCount, columnCompare, predicate.value, lanes.data(), column == 0 ? ScanKernels::Replace : ScanKernels::Or);
+      ScanKernels::combineMasks(lanes.constData(), wordCount, words, ScanKernels::And);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void FilterPlan::evaluateRange(const QVector<EditorObject*>& objects, const Chunk& range, const quint64* selection, const QVector<QSet<const EditorObject*>>& duplicates, quint8* matched) const
+{
+  for (int i = range.begin; i < range.end; ++i) {
+    const EditorObject* object = objects.at(i);
+
+    if (selection != nullptr) {
+      const int slot = object->getSlot();
+      if (((selection[slot / 64] >> (slot % 64)) & 1) == 0)
+        continue;
+    }
+
+    matched[i] = matchesNode(root, object, &duplicates, selection != nullptr);
+  }
+}
+
+QVector<EditorObject*> FilterPlan::apply(const QVector<EditorObject*>& objects) const
+{
+  if (isEmpty())
+    return objects;
+
+  const QBitArray selection = evaluate(objects);
+
+  QVector<EditorObject*> result;
+  result.reserve(selection.count(true));
+  for (int i = 0; i < objects.count(); ++i) {
+    if (selection.testBit(i))
+      result.append(objects.at(i));
+  }
+
+  return result;
+}
+
+bool FilterPlan::matchesNode(const int index, const EditorObject* object, const QVector<QSet<const EditorObject*>>* duplicates, const bool skipScanned) const
+{
+  const Node& node = nodes.at(index);
+
+  switch (node.type) {
+  case Leaf:
+    // Scanned predicates only get here if they matched already
+    if (skipScanned && predicates.at(node.predicate).scannable)
+      return true;
+    return matches(predicates.at(node.predicate), object, duplicates != nullptr ? &duplicates->at(node.predicate) : nullptr);
+  case All:
+    foreach(const int child, node.children) {
+      if (!matchesNode(child, object, duplicates, skipScanned))
+        return false;
+    }
+    return true;
+  case Any:
+    foreach(const int child, node.children) {
+      if (matchesNode(child, object, duplicates, skipScanned))
+        return true;
+    }
+    return false;
+  case Not:
+    return !matchesNode(node.children.first(), object, duplicates, skipScanned);
+  }
+
+  return false;
+}
+
+bool FilterPlan::matches(const Predicate& predicate, const EditorObject* object, const QSet<const EditorObject*>* duplicates)
+{
+  const TrackStore& store = object->getStore();
+  const int slot = object->getSlot();
+
+  switch (predicate.kind) {
+  case Prefab:
+    return int(store.getPrefabId(slot)) == predicate.value;
+  case Gate:
+    // Only actual gates have a gate number to compare
+    if (!store.hasCapability(slot, PrefabRegistry::Gate) || store.getValue(TrackStore::GateNo, slot) <= 0)
+      return false;
+    return compare(predicate, store.getValue(TrackStore::GateNo, slot));
+  case Column:
+    for (int column = predicate.firstColumn; column < predicate.firstColumn + predicate.columnCount; ++column) {
+      if (compare(predicate, store.getValue(TrackStore::Column(column), slot)))
+        return true;
+    }
+    return false;
+  case OnSpline:
+    return object->isOnSpline();
+  case Duplicate:
+    return duplicates != nullptr && duplicates->contains(object);
+  }
+
+  return false;
+}
+
+bool FilterPlan::compare(const Predicate& predicate, const int value)
+{
+  switch (predicate.method) {
+  case FilterMethods::Contains: return containsText(predicate, value);
+  case FilterMethods::Is: return value == predicate.value;
+  case FilterMethods::SmallerThan: return value < predicate.value;
+  case FilterMethods::BiggerThan: return value > predicate.value;
+  }
+
+  return false;
+}
+
+bool FilterPlan::containsText(const Predicate& predicate, const int value)
+{
+  // Same as searching the filter value in the formatted value, just without the strings
+  char text[12];
+  const int textLength = toDecimal(value, text);
+
+  return std::search(text, text + textLength, predicate.text, predicate.text + predicate.textLength) != text + textLength;
+}
+
+ScanKernels::Compare FilterPlan::toCompare(const FilterMethods method)
+{
+  switch (method) {
+  case FilterMethods::SmallerThan: return ScanKernels::Less;
+  case FilterMethods::BiggerThan: return ScanKernels::Greater;
+  default: return ScanKernels::Equal;
+  }
+}
+
+int FilterPlan::toDecimal(const int value, char* buffer)
+{
+  char digits[12];
+  int digitCount = 0;
+
+  qint64 remaining = qAbs(qint64(value));
+  do {
+    digits[digitCount++] = char('0' + remaining % 10);
+    remaining /= 10;
+  } while (remaining > 0);
+
+  int length = 0;
+  if (value < 0)
+    buffer[length++] = '-';
+  while (digitCount > 0)
+    buffer[length++] = digits[--digitCount];
+
+  return length;
+}
@@ -0,0 +1,139 @@
+#ifndef FILTERPLAN_H
+#define FILTERPLAN_H
+
+#include <QBitArray>
+#include <QSet>
+#include <QVector>
+
+#include "scankernels.h"
+#include "searchfilter.h"
+#include "searchquery.h"
+#include "trackstore.h"
+
+class EditorObject;
+class TrackStatistics;
+
+// The filters of a search compiled into typed predicates on the track store columns.
+// A plain filter list has to match completely, a query can combine the predicates with and/or/not.
+// The children of every and/or are ordered by how likely they decide the outcome for their cost,
+// estimated from the statistics of the track if there are any, and every object is checked in one
+// pass, stopping as soon as the outcome is known.
+// Plain comparisons that have to match on their own are done up front on whole columns by the
+// scan kernels, if the searched objects make up enough of the store for that to pay off.
+// Large searches are split into chunks that run on the global thread pool, the result does not
+// depend on the execution mode.
+class FilterPlan
+{
+public:
+  enum Execution {
+    Automatic,
+    Serial,
+    Parallel
+  };
+
+  // The statistics are only used while the plan gets built
+  explicit FilterPlan(const QVector<SearchFilter>& filterList, const TrackStatistics* statistics = nullptr);
+  explicit FilterPlan(const SearchQuery& query, const TrackStatistics* statistics = nullptr);
+
+  bool isEmpty() const;
+  bool accepts(const EditorObject* object) const;
+
+  // Whether an object matches depends on the other objects (duplicates), so single objects can not be checked
+  bool dependsOnAllObjects() const;
+
+  Execution getExecution() const;
+  void setExecution(const Execution value);
+
+  QBitArray evaluate(const QVector<EditorObject*>& objects) const;
+  QVector<EditorObject*> apply(const QVector<EditorObject*>& objects) const;
+
+private:
+  enum PredicateKind {
+    Prefab,
+    Column,
+    Gate,
+    OnSpline,
+    Duplicate
+  };
+
+  enum NodeType {
+    Leaf,
+    All,
+    Any,
+    Not
+  };
+
+  struct Node
+  {
+    NodeType type;
+
+    // Only set for leaves, the other nodes have children
+    int predicate;
+    QVector<int> children;
+
+    // Estimated fraction of the objects that match and the work to find out for one object
+    double selectivity;
+    double cost;
+  };
+
+  struct Predicate
+  {
+    PredicateKind kind;
+    FilterMethods method;
+    int value;
+
+    // Any* filters match if one of columnCount consecutive columns matches
+    TrackStore::Column firstColumn;
+    int columnCount;
+
+    // The value as decimal text, for Contains
+    char text[12];
+    int textLength;
+
+    // Has to match on its own and can be evaluated by the scan kernels
+    bool scannable;
+  };
+
+  struct Chunk
+  {
+    int begin;
+    int end;
+  };
+
+  QVector<Predicate> predicates;
+  QVector<Node> nodes;
+  int root = -1;
+  bool hasScannablePredicates = false;
+  bool isThreadSafe = true;
+  bool hasDuplicatePredicates = false;
+  Execution execution = Automatic;
+
+  // Below this many objects splitting up the work costs more than it saves
+  static const int parallelThreshold = 32768;
+  static const int chunkSize = 8192;
+
+  int compile(const SearchQuery& query, const int index, const TrackStatistics* statistics);
+  int compileFilter(const SearchFilter& filter, const TrackStatistics* statistics);
+  int addNode(const Node& node);
+  void orderChildren(Node& node) const;
+  void findScannablePredicates();
+
+  static double estimateSelectivity(const Predicate& predicate, const TrackStatistics* statistics);
+  static double estimateCost(const Predicate& predicate);
+  static double guessSelectivity(const FilterMethods method);
+
+  bool runParallel(const int count) const;
+  static QVector<Chunk> createChunks(const int count, const int size);
+
+  void scanWords(const TrackStore& store, const int firstWord, const int lastWord, quint64* selection) const;
+  void evaluateRange(const QVector<EditorObject*>& objects, const Chunk& range, const quint64* selection, const QVector<QSet<const EditorObject*>>& duplicates, quint8* matched) const;
+
+  bool matchesNode(const int index, const EditorObject* object, const QVector<QSet<const EditorObject*>>* duplicates, const bool skipScanned) const;
+  static bool matches(const Predicate& predicate, const EditorObject* object, const QSet<const EditorObject*>* duplicates = nullptr);
+  static bool compare(const Predicate& predicate, const int value);
+  static bool containsText(const Predicate& predicate, const int value);
+  static int toDecimal(const int value, char* buffer);
+  static ScanKernels::Compare toCompare(const FilterMethods method);
+};
+
+#endif // FILTERPLAN_H
@@ -1,5 +1,7 @@
 #include "filterproxymodel.h"
 
+#include "editormodel.h"
+
 FilterProxyModel::FilterProxyModel(QObject *parent)
   : QSortFilterProxyModel(parent)
 {
@@ -8,23 +10,15 @@ FilterProxyModel::FilterProxyModel(QObject *parent)
 
 bool FilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
-  Q_UNUSED(sourceRow)
-
-  // Only show items that have the filter mark set, if the filter is enabled
+  // Only show items that are in the filter, if the filter is enabled
   if (!searchFilterEnabled)
     return true;
 
-  if (sourceParent.data(USERROLE_FILTER).toBool())
-    return true;
-
-  QModelIndex parent = sourceParent.parent();
-  while(parent.isValid()) {
-    if (parent.data(USERROLE_FILTER).toBool())
-      return true;
-    parent = parent.parent();
-  }
+  if (editorModel == nullptr)
+    return sourceModel()->index(sourceRow, 0, sourceParent).data(USERROLE_FILTER).toBool();
 
-  return false;
+  const EditorModelItem* item = editorModel->itemFromIndex(sourceParent)->child(sourceRow);
+  return item != nullptr && item->isInFilter();
 }
 
 bool FilterProxyModel::isSearchFilterEnabled() const
@@ -34,6 +28,15 @@ bool FilterProxyModel::isSearchFilterEnabled() const
 
 void FilterProxyModel::setSearchFilter(bool enabled)
 {
+  if (searchFilterEnabled == enabled)
+    return;
+
   searchFilterEnabled = enabled;
   invalidateFilter();
 }
+
+void FilterProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
+{
+  editorModel = qobject_cast<const EditorModel*>(sourceModel);
+  QSortFilterProxyModel::setSourceModel(sourceModel);
+}
@@ -8,6 +8,11 @@
 
 #define USERROLE_FILTER 1000
 
+class EditorModel;
+
+// Shows only the marked items with their content and the path that leads to them, if the filter is enabled.
+// Editor models keep a summary of the marks around every item, so a row is checked without walking the tree
+// and recursive filtering is not needed. Mark changes are reported as dataChanged on the rows they affect.
 class FilterProxyModel : public QSortFilterProxyModel
 {
   Q_OBJECT
@@ -18,11 +23,14 @@ public:
   bool isSearchFilterEnabled() const;
   void setSearchFilter(bool enabled);
 
+  void setSourceModel(QAbstractItemModel* sourceModel) override;
+
 protected:
   bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
 
 private:
   bool searchFilterEnabled = false;
+  const EditorModel* editorModel = nullptr;
 };
 
 #endif // PREFABSORTFILTERPROXYMODEL_H
@@ -0,0 +1,274 @@
+#include "jsonreader.h"
+
+#include <cmath>
+
+JsonReader::JsonReader(const QByteArray& data) :
+  begin(data.constData()),
+  cursor(data.constData()),
+  end(data.constData() + data.size())
+{
+}
+
+void JsonReader::beginArray()
+{
+  expect('[');
+  firstInContainer = true;
+}
+
+void JsonReader::beginObject()
+{
+  expect('{');
+  firstInContainer = true;
+}
+
+bool JsonReader::hasNextElement()
+{
+  return hasNext(']');
+}
+
+bool JsonReader::hasNextMember()
+{
+  return hasNext('}');
+}
+
+JsonReader::ValueType JsonReader::peek()
+{
+  skipWhitespace();
+  if (cursor >= end)
+    return ValueType::Invalid;
+
+  switch (*cursor) {
+  case '{': return ValueType::Object;
+  case '[': return ValueType::Array;
+  case '"': return ValueType::String;
+  case 't':
+  case 'f': return ValueType::Bool;
+  case 'n': return ValueType::Null;
+  default:
+    if (*cursor == '-' || (*cursor >= '0' && *cursor <= '9'))
+      return ValueType::Number;
+  }
+
+  return ValueType::Invalid;
+}
+
+QLatin1String JsonReader::readKey()
+{
+  skipWhitespace();
+  if (cursor >= end || *cursor != '"')
+    throwSyntaxError();
+
+  // Keys are compared as they are, none of the keys we look for contains escapes
+  const char* keyBegin = cursor + 1;
+  const char* keyEnd = skipString();
+  cursor = keyEnd + 1;
+
+  expect(':');
+
+  return QLatin1String(keyBegin, int(keyEnd - keyBegin));
+}
+
+bool JsonReader::readBool()
+{
+  switch (peek()) {
+  case ValueType::Bool:
+    if (end - cursor >= 4 && qstrncmp(cursor, "true", 4) == 0) {
+      cursor += 4;
+      return true;
+    }
+    if (end - cursor >= 5 && qstrncmp(cursor, "false", 5) == 0) {
+      cursor += 5;
+      return false;
+    }
+    break;
+  case ValueType::Number:
+    return readDouble() != 0.0;
+  case ValueType::Null:
+    skipValue();
+    return false;
+  default:
+    break;
+  }
+
+  throwSyntaxError();
+}
+
+double JsonReader::readDouble()
+{
+  if (peek() != ValueType::Number) {
+    skipValue();
+    return 0.0;
+  }
+
+  qint64 integer = 0;
+  double real = 0.0;
+  if (readNumber(integer, real))
+    return double(integer);
+
+  return real;
+}
+
+int JsonReader::readInt()
+{
+  if (peek() != ValueType::Number) {
+    skipValue();
+    return 0;
+  }
+
+  qint64 integer = 0;
+  double real = 0.0;
+  if (readNumber(integer, real))
+    return int(integer);
+
+  return int(std::round(real));
+}
+
+uint JsonReader::readUInt()
+{
+  const int value = readInt();
+  return value > 0 ? uint(value) : 0;
+}
+
+void JsonReader::skipValue()
+{
+  switch (peek()) {
+  case ValueType::Object:
+    beginObject();
+    while (hasNextMember()) {
+      readKey();
+      skipValue();
+    }
+    break;
+  case ValueType::Array:
+    beginArray();
+    while (hasNextElement())
+      skipValue();
+    break;
+  case ValueType::String:
+    cursor = skipString() + 1;
+    break;
+  case ValueType::Number: {
+    qint64 integer = 0;
+    double real = 0.0;
+    readNumber(integer, real);
+    break;
+  }
+  case ValueType::Bool:
+    readBool();
+    break;
+  case ValueType::Null:
+    if (end - cursor < 4 || qstrncmp(cursor, "null", 4) != 0)
+      throwSyntaxError();
+    cursor += 4;
+    break;
+  case ValueType::Invalid:
+    throwSyntaxError();
+  }
+}
+
+int JsonReader::position() const
+{
+  return int(cursor - begin);
+}
+
+int JsonReader::offsetOf(const QLatin1String& key) const
+{
+  return int(key.data() - begin);
+}
+
+void JsonReader::expect(const char character)
+{
+  skipWhitespace();
+  if (cursor >= end || *cursor != character)
+    throwSyntaxError();
+
+  ++cursor;
+}
+
+bool JsonReader::hasNext(const char closingCharacter)
+{
+  skipWhitespace();
+  if (cursor >= end)
+    throwSyntaxError();
+
+  if (*cursor == closingCharacter) {
+    ++cursor;
+    firstInContainer = false;
+    return false;
+  }
+
+  if (firstInContainer) {
+    firstInContainer = false;
+    return true;
+  }
+
+  expect(',');
+
+  return true;
+}
+
+bool JsonReader::readNumber(qint64& integer, double& real)
+{
+  const char* numberBegin = cursor;
+
+  const bool negative = (*cursor == '-');
+  if (negative)
+    ++cursor;
+
+  // Tracks store almost everything as integers, so we parse those directly
+  integer = 0;
+  while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+    integer = integer * 10 + (*cursor - '0');
+    ++cursor;
+  }
+
+  if (cursor < end && (*cursor == '.' || *cursor == 'e' || *cursor == 'E')) {
+    while (cursor < end && (*cursor == '.' || *cursor == 'e' || *cursor == 'E' || *cursor == '+' || *cursor == '-' || (*cursor >= '0' && *cursor <= '9')))
+      ++cursor;
+
+    bool ok = false;
+    real = QByteArray::fromRawData(numberBegin, int(cursor - numberBegin)).toDouble(&ok);
+    if (!ok)
+      throwSyntaxError();
+
+    return false;
+  }
+
+  if (cursor == numberBegin + (negative ? 1 : 0))
+    throwSyntaxError();
+
+  if (negative)
+    integer = -integer;
+
+  return true;
+}
+
+const char* JsonReader::skipString()
+{
+  // Expects the cursor on the opening quote and returns the position of the closing one
+  const char* position = cursor + 1;
+  while (position < end) {
+    if (*position == '\\') {
+      position += 2;
+      continue;
+    }
+
+    if (*position == '"')
+      return position;
+
+    ++position;
+  }
+
+  throwSyntaxError();
+}
+
+void JsonReader::skipWhitespace()
+{
+  while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t'))
+    ++cursor;
+}
+
+void JsonReader::throwSyntaxError() const
+{
+  throw JsonSyntaxException(position());
+}
@@ -0,0 +1,68 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArray>
+#include <QLatin1String>
+#include <QString>
+
+#include "exceptions.h"
+
+class JsonSyntaxException : public VeloToolkitException
+{
+public:
+  JsonSyntaxException(const int offset) :
+    VeloToolkitException(QString("Invalid Track data. Unexpected character at offset %1.").arg(offset)) {}
+};
+
+// Forward only pull reader over a json buffer. It reads values straight out of the buffer
+// without building a document, so the caller decides what to keep and what to skip.
+class JsonReader
+{
+public:
+  enum class ValueType {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object,
+    Invalid
+  };
+
+  explicit JsonReader(const QByteArray& data);
+
+  void beginArray();
+  void beginObject();
+  bool hasNextElement();
+  bool hasNextMember();
+
+  ValueType peek();
+  QLatin1String readKey();
+
+  bool readBool();
+  double readDouble();
+  int readInt();
+  uint readUInt();
+  void skipValue();
+
+  int position() const;
+  // Where a key returned by readKey() starts in the data
+  int offsetOf(const QLatin1String& key) const;
+
+private:
+  const char* begin;
+  const char* cursor;
+  const char* end;
+
+  // Set by beginArray()/beginObject(), so the first hasNext call doesn't expect a separator
+  bool firstInContainer = false;
+
+  void expect(const char character);
+  bool hasNext(const char closingCharacter);
+  bool readNumber(qint64& integer, double& real);
+  const char* skipString();
+  void skipWhitespace();
+  [[noreturn]] void throwSyntaxError() const;
+};
+
+#endif // JSONREADER_H
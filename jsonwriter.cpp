@@ -0,0 +1,110 @@
+#include "jsonwriter.h"
+
+#include <cmath>
+#include <QLocale>
+
+JsonWriter::JsonWriter(const int reserveSize)
+{
+  buffer.reserve(reserveSize);
+}
+
+void JsonWriter::beginArray()
+{
+  beginValue();
+  buffer.append('[');
+  needsSeparator = false;
+}
+
+void JsonWriter::beginObject()
+{
+  beginValue();
+  buffer.append('{');
+  needsSeparator = false;
+}
+
+void JsonWriter::endArray()
+{
+  buffer.append(']');
+  needsSeparator = true;
+}
+
+void JsonWriter::endObject()
+{
+  buffer.append('}');
+  needsSeparator = true;
+}
+
+void JsonWriter::writeKey(const char* key, const int keySize)
+{
+  beginValue();
+  buffer.append('"');
+  buffer.append(key, keySize);
+  buffer.append("\":", 2);
+  needsSeparator = false;
+}
+
+void JsonWriter::writeBool(const bool value)
+{
+  beginValue();
+  if (value)
+    buffer.append("true", 4);
+  else
+    buffer.append("false", 5);
+  needsSeparator = true;
+}
+
+void JsonWriter::writeDouble(const double value)
+{
+  // Whole numbers are written like integers, everything else with the shortest exact representation
+  if (std::abs(value) < 1e9 && value == std::floor(value)) {
+    writeInt(int(value));
+    return;
+  }
+
+  beginValue();
+  buffer.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+  needsSeparator = true;
+}
+
+void JsonWriter::writeInt(const int value)
+{
+  beginValue();
+
+  // Positions, rotations and scalings are all integers, so this is the hot path of every export
+  char digits[12];
+  int position = sizeof(digits);
+  unsigned int remaining = value < 0 ? 0u - unsigned(value) : unsigned(value);
+  do {
+    digits[--position] = char('0' + remaining % 10);
+    remaining /= 10;
+  } while (remaining > 0);
+
+  if (value < 0)
+    digits[--position] = '-';
+
+  buffer.append(digits + position, int(sizeof(digits)) - position);
+  needsSeparator = true;
+}
+
+void JsonWriter::writeRaw(const char* data, const int size)
+{
+  beginValue();
+  buffer.append(data, size);
+  needsSeparator = true;
+}
+
+QByteArray& JsonWriter::data()
+{
+  return buffer;
+}
+
+int JsonWriter::size() const
+{
+  return buffer.size();
+}
+
+void JsonWriter::beginValue()
+{
+  if (needsSeparator)
+    buffer.append(',');
+}
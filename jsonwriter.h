@@ -0,0 +1,37 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+
+// Appends compact json to a single pre-reserved buffer. Separators are inserted automatically,
+// so the caller only has to write keys and values in the order they should appear.
+class JsonWriter
+{
+public:
+  explicit JsonWriter(const int reserveSize = 0);
+
+  void beginArray();
+  void beginObject();
+  void endArray();
+  void endObject();
+
+  void writeKey(const char* key, const int keySize);
+  void writeBool(const bool value);
+  void writeDouble(const double value);
+  void writeInt(const int value);
+  void writeRaw(const char* data, const int size);
+
+  template<int N>
+  void writeKey(const char (&key)[N]) { writeKey(key, N - 1); }
+
+  QByteArray& data();
+  int size() const;
+
+private:
+  QByteArray buffer;
+  bool needsSeparator = false;
+
+  void beginValue();
+};
+
+#endif // JSONWRITER_H
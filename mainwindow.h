@@ -94,6 +94,7 @@ private slots:
   void on_searchClearFilterPushButton_released();
   void on_searchFilterGroupBox_toggled(bool newState);
   void on_searchOptionsShowOnlyFilteredCheckBox_stateChanged(int checked);
+  void on_searchQueryLineEdit_returnPressed();
   void on_searchSubtypeComboBox_currentIndexChanged(const QString &subtypeDesc);
   void on_searchTypeComboBox_currentIndexChanged(const QString &filterDesc);
   void on_searchTypeRotationWValueSpinBox_valueChanged(int value);
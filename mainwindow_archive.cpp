@@ -22,12 +22,7 @@ void MainWindow::loadArchive()
 
     // Get the scene of the track if we got a database
     if (database != nullptr) {
-      foreach(SceneData scene, database->getScenes()) {
-        if (scene.id == track.sceneId) {
-          trackItem->setText(TrackTreeColumns::SceneColumn, scene.title);
-          break;
-        }
-      }
+      trackItem->setText(TrackTreeColumns::SceneColumn, database->getScene(track.sceneId).title);
     } else {
       // if we dont have a database use the scene id as fallback
       trackItem->setText(TrackTreeColumns::SceneColumn, QString("%1").arg(track.sceneId, 0, 10));
@@ -60,8 +55,8 @@ void MainWindow::loadDatabaseForArchive(VeloDb* database)
   if (database == nullptr)
     return;
 
-  // Query all data from the database
-  database->queryAll();
+  // Query the data from the database, unless the cached catalog is still up to date
+  database->refreshAll();
 
   // Insert tracks into the archive track selection tree view
   int row = 0;
@@ -72,14 +67,8 @@ void MainWindow::loadDatabaseForArchive(VeloDb* database)
     // Set the track name as item text
     trackItem->setText(0, track.name);
 
-    // Get the scene of the track
-    foreach(SceneData scene, database->getScenes()) {
-      if (scene.id == track.sceneId) {
-        // Set the scene title in the scene column
-        trackItem->setText(TrackTreeColumns::SceneColumn, scene.title);
-        break;
-      }
-    }
+    // Set the scene title of the track in the scene column
+    trackItem->setText(TrackTreeColumns::SceneColumn, database->getScene(track.sceneId).title);
 
     // Insert the track data into the tree view item as user data
     QVariant var;
@@ -151,26 +140,33 @@ void MainWindow::on_archiveAddTrackPushButton_released()
     return;
   }
 
-  // If we move the track we have to delete it from the origin database
-  // Gets the origin database
+  // Gets the origin database, we need it to load the track data
+  // and if we move the track we have to delete it from there as well
   QString selectedDbStr = ui->archiveDatabaseSelectionComboBox->currentText();
   VeloDb* selectedDbInArchive = nullptr;
-  if (ui->archiveMoveToArchiveCheckBox->checkState() == Qt::Checked) {
-    if (selectedDbStr == tr("Production")) {
-      selectedDbInArchive = productionDb;
-    } else if (selectedDbStr == tr("Beta")) {
-      selectedDbInArchive = betaDb;
-    } else if (selectedDbStr == tr("Custom")) {
-      selectedDbInArchive = customDb;
-    } else {
-      // ToDo: Errorhandling
-      return;
-    }
+  if (selectedDbStr == tr("Production")) {
+    selectedDbInArchive = productionDb;
+  } else if (selectedDbStr == tr("Beta")) {
+    selectedDbInArchive = betaDb;
+  } else if (selectedDbStr == tr("Custom")) {
+    selectedDbInArchive = customDb;
+  } else {
+    // ToDo: Errorhandling
+    return;
   }
 
   // Archive all selected tracks
   foreach(QTreeWidgetItem* selectedTrackItem, selection) {
     TrackData track = selectedTrackItem->data(0, Qt::UserRole).value<TrackData>();
+
+    // The selection only holds the catalog entry, so load the track data first
+    try {
+      selectedDbInArchive->loadTrackValue(track);
+    } catch (VeloToolkitException& e) {
+      e.Message();
+      return;
+    }
+
     // If we move the track we have to delete it from the origin database
     // Deletes the track from the origin database
     if (ui->archiveMoveToArchiveCheckBox->checkState() == Qt::Checked) {
@@ -61,6 +61,10 @@ void MainWindow::on_mergeTrackPushButton_released()
 //  // Create a new velo track manager
 //  NodeEditor newEditor;
 //  try {
+//    // The selection only holds the catalog entries, so load the track data first
+//    getDatabase(mergeTrack1.assignedDatabase)->loadTrackValue(mergeTrack1);
+//    getDatabase(mergeTrack2.assignedDatabase)->loadTrackValue(mergeTrack2);
+//
 //    // Set the prefabs
 //    newEditor.setPrefabs(getDatabase(mergeTrack1.assignedDatabase)->getPrefabs());
 
@@ -79,7 +83,7 @@ void MainWindow::on_mergeTrackPushButton_released()
 //  newTrack.sceneId = mergeTrack1.sceneId;
 //  newTrack.assignedDatabase = mergeTrack1.assignedDatabase;
 //  newTrack.protectedTrack = 0;
-//  newTrack.value = *newEditor.exportAsJsonData();
+//  newTrack.value = newEditor.exportAsJsonData();
 
 //  // Save the track into the database
 //  try {
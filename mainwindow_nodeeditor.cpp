@@ -48,7 +48,16 @@ void MainWindow::loadTrack(const TrackData& track)
   if (veloDb == nullptr)
     return;
 
-  nodeEditorManager->addEditor(veloDb->getPrefabs(), track);
+  // The track list only holds the catalog, so we have to fetch the json now
+  TrackData trackData = track;
+  try {
+    veloDb->loadTrackValue(trackData);
+  } catch (VeloToolkitException& e) {
+    e.Message();
+    return;
+  }
+
+  nodeEditorManager->addEditor(veloDb->getPrefabRegistry(), trackData, veloDb->getUserDbFilename());
 
   // Load the scenes into the combo box
   bool loaded = false;
@@ -129,7 +138,7 @@ void MainWindow::saveTrackToDb()
 
   // Write the selected scene and any node changes to the currently loaded track
   track.sceneId = ui->sceneComboBox->currentData().toUInt();
-  track.value = *nodeEditor->exportAsJsonData();
+  track.value = nodeEditor->exportAsJsonData();
 
   // Message for later output
   QString message = tr("The track was saved successfully to the database!");
@@ -177,7 +186,7 @@ void MainWindow::saveTrackToFile()
   QFile *file = new QFile("track.json");
   file->remove();
   file->open(QFile::ReadWrite);
-  file->write(*nodeEditor->exportAsJsonData());
+  file->write(nodeEditor->exportAsJsonData());
   file->close();
 }
 
@@ -322,7 +331,7 @@ void MainWindow::on_refreshTrackPushButton_released()
     return;
 
   try {
-    veloDb->queryTracks();
+    veloDb->refreshTracks();
   } catch (VeloToolkitException& e) {
     e.Message();
     return;
@@ -29,6 +29,31 @@ void MainWindow::on_searchAddFilterPushButton_released()
     searchFilterLayout->addFilter(FilterTypes::RotationZ,
                                   FilterMethods::Is,
                                   ui->searchTypeRotationZValueSpinBox->value());
+  } else if (filterType == FilterTypes::Query) {
+    // Prefab names are looked up in the prefabs of the current track
+    QVector<PrefabData> prefabs;
+    const NodeEditor* nodeEditor = nodeEditorManager->getEditor();
+    if (nodeEditor != nullptr)
+      prefabs = nodeEditor->getTrack()->getAvailablePrefabs();
+
+    SearchQueryPtr query;
+    try {
+      query = SearchQueryPtr(new SearchQuery(SearchQuery::parse(ui->searchQueryLineEdit->text(), prefabs)));
+    } catch (InvalidSearchQueryException& e) {
+      e.Message();
+      return;
+    }
+
+    if (query->isEmpty())
+      return;
+
+    currentCacheId++;
+
+    // The whole query becomes one filter
+    searchFilterLayout->addFilter(query);
+
+    // Set our toolbox target to filtered objects
+    ui->toolsTargetComboBox->setCurrentIndex(2);
   } else {
     QString displayValue = "";
     int value = 0;
@@ -100,6 +125,11 @@ void MainWindow::on_searchOptionsShowOnlyFilteredCheckBox_stateChanged(int check
   nodeEditor->getFilteredModel().setSearchFilter(checked > 0);
 }
 
+void MainWindow::on_searchQueryLineEdit_returnPressed()
+{
+  on_searchAddFilterPushButton_released();
+}
+
 void MainWindow::on_searchSubtypeComboBox_currentIndexChanged(const QString &subtypeDesc)
 {
   ui->searchFilterValueStackedWidget->setCurrentIndex(subtypeDesc == tr("From angle") ? 1 : 0);
@@ -112,6 +142,7 @@ void MainWindow::on_searchTypeComboBox_currentIndexChanged(const QString &filter
   qDebug() << filterDesc << type;
   int minValue = -999999;
   int maxValue = 999999;
+  ui->searchQueryLineEdit->setVisible(type == FilterTypes::Query);
   switch (type) {
   case FilterTypes::Object:
     ui->searchMethodComboBox->hide();
@@ -162,8 +193,29 @@ void MainWindow::on_searchTypeComboBox_currentIndexChanged(const QString &filter
     ui->searchValueLine->show();
     break;
 
-  case FilterTypes::IsOnSpline:
   case FilterTypes::IsDublicate:
+    // The value is the tolerance for near duplicates
+    ui->searchMethodComboBox->hide();
+    ui->searchSubtypeComboBox->hide();
+    ui->searchValueComboBox->hide();
+    ui->searchValueLabel->show();
+    ui->searchValueSpinBox->show();
+    ui->searchValueSpinBox->setMinimum(0);
+    ui->searchValueSpinBox->setMaximum(1000);
+    ui->searchValueSpinBox->setValue(0);
+    ui->searchValueLine->show();
+    break;
+
+  case FilterTypes::Query:
+    ui->searchMethodComboBox->hide();
+    ui->searchSubtypeComboBox->hide();
+    ui->searchValueComboBox->hide();
+    ui->searchValueLabel->show();
+    ui->searchValueSpinBox->hide();
+    ui->searchValueLine->show();
+    break;
+
+  case FilterTypes::IsOnSpline:
     ui->searchMethodComboBox->hide();
     ui->searchSubtypeComboBox->hide();
     ui->searchValueComboBox->hide();
@@ -268,10 +320,11 @@ void MainWindow::updateSearch(bool filterEnabled)
     return;
   }
 
-  // Update the search cache if nescessary
-  if (nodeEditor->getSearchCacheId() != currentCacheId) {
-    nodeEditor->setSearchResult(currentCacheId, nodeEditor->search(nodeEditor->getTrack()->getObjects(), searchFilterLayout->getFilterList()));
-  }
+  // Update the search cache if nescessary, otherwise only objects changed since then are checked again
+  if (nodeEditor->getSearchCacheId() != currentCacheId)
+    nodeEditor->runSearch(currentCacheId, searchFilterLayout->getFilters());
+  else
+    nodeEditor->refreshSearch();
 
   // Mark all found items
   nodeEditor->beginNodeEdit();
@@ -8,173 +8,18 @@ NodeEditor::NodeEditor(Track& track)
 
   editorModel = new EditorModel(&track, this);
 
-  filteredModel.setRecursiveFilteringEnabled(true);
+  // The model keeps track of marked descendants itself, so the proxy does not have to search for them
   filteredModel.setSourceModel(editorModel);
-}
 
-void NodeEditor::beginNodeEdit()
-{
-  qDebug() << "NodeEditor::beginNodeEdit() Started: " << editStarted;
-//  // Everytime we start to do a lot of changes to the tree, we memorize if the root node was expanded
-//  // and collapse it for performance reasons (so any redraw / update call is processed way faster)
-//  if (editStarted)
-//    return;
-
-//  editStarted = true;
-
-//  if (treeView->verticalScrollBar() != nullptr && treeView->verticalScrollBar()->maximum() > 0)
-//    lastScrollbarPos = float(treeView->verticalScrollBar()->value()) / float(treeView->verticalScrollBar()->maximum());
-
-//  QModelIndex index;
-//  for (int i = 0; i < editorModel->getRootItem()->childCount(); ++i) {
-//    index = filteredModel.mapFromSource(editorModel->getRootItem()->child(i)->getIndex());
-//    lastTreeExpansionStates.append(index.isValid() && treeView->isExpanded(index));
-//    treeView->collapse(index);
-//  }
+  // Edits through the delegates only go through the model
+  connect(editorModel, &EditorModel::dataChanged, this, [this]() { refreshSearch(); });
 }
 
-void NodeEditor::applyFilterToList(QVector<EditorObject*>& matchingItems, const QVector<NodeFilter*>& filter, const FilterTypes filterType, const QVector<EditorObject*>* initalItems)
+void NodeEditor::beginNodeEdit()
 {
-  // Define our control variables outside of the loops to prevent excessive alloc and deallocs
-  bool match = false;
-  int rowCount = 1;
-  QString filterValue = "";
-  QString prefabValue = "";
-  NodeFilter* nodeFilter = nullptr;
-
-  // Go through every filter in the list  and eventually remove all items that dont apply to it
-  for (int i = 0; i < filter.count(); ++i) {
-    nodeFilter = filter.at(i);
-
-    if (nodeFilter == nullptr || nodeFilter->getFilterType() != filterType)
-      continue;
-
-    filterValue = QString("%1").arg(nodeFilter->getFilterValue());
-
-    // Every filter is applied to every remaining item in the list
-    for (int item = 0; item < matchingItems.count(); ++item) {
-      match = false;
-
-      EditorObject* prefab = matchingItems.at(item);
-
-      if (filterType == FilterTypes::GateNo && !prefab->isGate()) {
-        matchingItems.removeOne(prefab);
-        item--;
-        continue;
-      }
-
-      // Some filter need to loop through multiple rows
-      switch (filterType) {
-      case FilterTypes::AnyPosition:
-      case FilterTypes::AnyScaling:
-        rowCount = 3;
-        break;
-      case FilterTypes::AnyRotation:
-        rowCount = 4;
-        break;
-      default:
-        rowCount = 1;
-      }
-      for (int row = 0; row < rowCount; ++row) {
-        // Set the corresponding value of the filter and apply it
-        switch (filterType) {
-        case FilterTypes::Object:
-          // We can do the check right away to save some nanoseconds lmao
-          match = (int(prefab->getId()) == nodeFilter->getFilterValue());
-          continue;
-        case FilterTypes::AnyPosition:
-          prefabValue = QString("%1").arg(prefab->getPosition(row));
-          break;
-        case FilterTypes::PositionR:
-          prefabValue = QString("%1").arg(prefab->getPositionR());
-          break;
-        case FilterTypes::PositionG:
-          prefabValue = QString("%1").arg(prefab->getPositionG());
-          break;
-        case FilterTypes::PositionB:
-          prefabValue = QString("%1").arg(prefab->getPositionB());
-          break;
-        case FilterTypes::AnyRotation:
-          prefabValue = QString("%1").arg(prefab->getRotationVector(row));
-          break;
-        case FilterTypes::RotationW:
-          prefabValue = QString("%1").arg(prefab->getRotationW());
-          break;
-        case FilterTypes::RotationX:
-          prefabValue = QString("%1").arg(prefab->getRotationX());
-          break;
-        case FilterTypes::RotationY:
-          prefabValue = QString("%1").arg(prefab->getRotationY());
-          break;
-        case FilterTypes::RotationZ:
-          prefabValue = QString("%1").arg(prefab->getRotationZ());
-          break;
-        case FilterTypes::AnyScaling:
-          prefabValue = QString("%1").arg(prefab->getScaling(row));
-          break;
-        case FilterTypes::ScalingR:
-          prefabValue = QString("%1").arg(prefab->getScalingR());
-          break;
-        case FilterTypes::ScalingG:
-          prefabValue = QString("%1").arg(prefab->getScalingG());
-          break;
-        case FilterTypes::ScalingB:
-          prefabValue = QString("%1").arg(prefab->getScalingB());
-          break;
-        case FilterTypes::GateNo:
-          prefabValue = QString("%1").arg(prefab->getGateNo());
-          break;
-        case FilterTypes::IsOnSpline:
-          if (prefab->isOnSpline())
-            match = true;
-          continue;
-        case FilterTypes::IsDublicate: {
-          // Check if the prefab matches any other prefab
-          for(int i = 0; i < initalItems->count(); ++i) {
-            const EditorObject* item = initalItems->at(i);
-            if (item->isSpline() || item->isOnSpline() || item->isSplineControl())
-              continue;
-
-            if (item->getIndex() != prefab->getIndex() && item == prefab)
-              match = true;
-          }
-          continue;
-        }
-        default:
-          continue;
-        }
-
-        switch (nodeFilter->getFilterMethod()) {
-        case FilterMethods::Contains:
-          if (prefabValue.indexOf(filterValue) > -1)
-            match = true;
-          break;
-        case FilterMethods::Is:
-          if (prefabValue == filterValue)
-            match = true;
-          break;
-        case FilterMethods::SmallerThan:
-          if (prefabValue.toInt() < nodeFilter->getFilterValue())
-            match = true;
-          break;
-        case FilterMethods::BiggerThan:
-          if (prefabValue.toInt() > nodeFilter->getFilterValue())
-            match = true;
-          break;
-        }
-
-        // No need to process the other rows, if one matches
-        if (match)
-          break;
-      }
-
-      // If no filter matched this prefab, remove it from the list and decrement the iterator
-      if (!match) {
-        matchingItems.removeOne(prefab);
-        item--;
-      }
-    }
-  }
+  // Everything until the matching endNodeEdit() reaches the views as one batch of row changes
+  editDepth++;
+  editorModel->beginEdit();
 }
 
 void NodeEditor::changeGateOrder(const uint oldGateNo, const uint newGateNo)
@@ -201,17 +46,22 @@ void NodeEditor::clearFilterMarks()
 //  }
   for(int resultIdx = 0; resultIdx < searchResult.count(); ++resultIdx)
   {
-    searchResult[resultIdx]->setFilterMarked(false);
+    setFilterMark(searchResult[resultIdx], false);
   }
+
+  filterMarksSet = false;
 }
 
 void NodeEditor::clearModifiedFlag(EditorModelItem* modelItem)
 {
-  EditorModelItem* item = modelItem;
-  if (!item)
-    item = editorModel->getRootItem();
+  if (modelItem) {
+    modelItem->setModified(false);
+    return;
+  }
 
-  item->setModified(false);
+  // The root item has no object, so the whole track has to be cleared
+  foreach(EditorObject* object, track->getObjects())
+    object->setModified(false);
 }
 
 void NodeEditor::clearSearch(const int cacheId)
@@ -219,6 +69,7 @@ void NodeEditor::clearSearch(const int cacheId)
   searchCacheId = cacheId;
   clearFilterMarks();
   searchResult.clear();
+  searchPlan.reset();
 }
 
 void NodeEditor::deleteNode(const QModelIndex &index) const
@@ -230,18 +81,50 @@ void NodeEditor::deleteNode(const QModelIndex &index) const
   if (parentItem == nullptr)
     return;
 
-  parentItem->removeChild(index.row());
+  // Keep the track in sync, otherwise the object would still be exported
+  EditorModelItem* item = parentItem->child(index.row());
+  if (item != nullptr && item->hasObject()) {
+    EditorObject* object = item->getObject();
+    EditorObject* parentObject = object->getParentObject();
+
+    // Passes over the track store skip removed objects
+    object->setRemoved();
+
+    if (parentObject == nullptr) {
+      track->removeObject(object);
+    } else {
+      parentObject->removeSplineChild(object);
+      parentObject->setModified();
+    }
+  }
+
+  editorModel->removeItem(item);
 }
 
 QModelIndex NodeEditor::duplicateObject(EditorObject* sourceObject)
 {
-  EditorObject* newObject = new EditorObject(*sourceObject);
-  EditorModelItem* newItem = new EditorModelItem(newObject);
-  EditorModelItem* parent = sourceObject->getParentModelItem();
-  if (!parent)
+  // The copy is a sibling of its source, in the tree as well as in the track
+  EditorModelItem* sourceItem = sourceObject->getParentModelItem();
+  if (!sourceItem || sourceItem->getObject() != sourceObject || !sourceItem->getParentItem())
     return QModelIndex();
 
-  parent->addChild(*newItem);
+  EditorModelItem* parent = sourceItem->getParentItem();
+  EditorObject* newObject = sourceObject->getStore().cloneObject(*sourceObject);
+  EditorModelItem* newItem = editorModel->createItem(newObject);
+  editorModel->appendItem(parent, newItem);
+
+  // Add the copy next to its source, so it gets exported as well
+  EditorObject* parentObject = sourceObject->getParentObject();
+  if (parentObject == nullptr) {
+    track->addObject(newObject);
+  } else {
+    parentObject->addSplineCopy(sourceObject, newObject);
+  }
+  newObject->setParentObject(parentObject);
+
+  // The curve of the parent changed, so its old json can not be reused anymore
+  if (parentObject != nullptr)
+    parentObject->setModified();
 
   // Prevent invalid gate data
   if (newObject->isValid()) {
@@ -257,7 +140,7 @@ QModelIndex NodeEditor::duplicateObject(EditorObject* sourceObject)
 
   prefabCount++;
 
-  return editorModel->index(newItem->childNumber(), 0, parent->getIndex());
+  return editorModel->indexFromItem(newItem);
 
 
 //  // Clone the source columns and their children
@@ -296,46 +179,39 @@ QModelIndex NodeEditor::duplicateObject(EditorObject* sourceObject)
 
 void NodeEditor::endNodeEdit()
 {
-//  qDebug() << "NodeEditor::endNodeEdit() Started: " << editStarted;
-
-//  // Once we have finished our changes we restore the original view and move the scrollbar to its previous location
-//  if (!editStarted)
-//    return;
-
-//  editStarted = false;
+  if (editDepth == 0)
+    return;
 
-//  QModelIndex index;
-//  for (int i = 0; i < editorModel->getRootItem()->childCount(); ++i) {
-//    if (i >= lastTreeExpansionStates.count())
-//      break;
+  if (--editDepth > 0) {
+    editorModel->endEdit();
+    return;
+  }
 
-//    index = filteredModel.mapFromSource(editorModel->getRootItem()->child(i)->getIndex());
-//    if (lastTreeExpansionStates[i])
-//      treeView->expand(index);
-//  }
+  // Objects are edited directly in the store, so their rows are found through the changed slots
+  TrackStore& store = track->getStore();
+  const QVector<int> changedSlots = store.takeChangedSlots();
+  foreach(const int slot, changedSlots) {
+    if (!store.isLive(slot))
+      continue;
 
-//  if (treeView->verticalScrollBar() != nullptr && treeView->verticalScrollBar()->maximum() > 0)
-//    treeView->verticalScrollBar()->setValue(int(std::round(lastScrollbarPos * treeView->verticalScrollBar()->maximum())));
+    EditorObject* object = store.getObject(slot);
+    EditorModelItem* item = object->getParentModelItem();
+    if (item != nullptr && item->getObject() == object)
+      editorModel->refreshItem(item);
+  }
 
-//  lastTreeExpansionStates.clear();
+  // New marks are part of the same batch
+  refreshSearch(changedSlots);
+  editorModel->endEdit();
 }
 
-QByteArray *NodeEditor::exportAsJsonData()
+QByteArray NodeEditor::exportAsJsonData()
 {
-  VeloDataParser parser(editorModel);
-  QByteArray* veloByteData = parser.exportToJson();
-
-  if (nodeCount > parser.getNodeCount())
-    qDebug() << "Export error: Wrong node count! " << nodeCount << " vs " << parser.getNodeCount();
-
-  if (prefabCount != parser.getPrefabCount())
-    qDebug() << "Export error: Wrong prefab count!" << prefabCount << " vs " << parser.getPrefabCount();
+  VeloDataParser parser;
+  const QByteArray veloByteData = parser.exportToJson(*track);
 
-  if (gateCount != parser.getGateCount())
-    qDebug() << "Export error: Wrong gate count!" << gateCount << " vs " << parser.getGateCount();
-
-  if (splineCount != parser.getSplineCount())
-    qDebug() << "Export error: Wrong spline count!" << splineCount << " vs " << parser.getSplineCount();
+  if (int(parser.getGateCount()) != track->getGateCount())
+    qDebug() << "Export error: Wrong gate count!" << track->getGateCount() << " vs " << parser.getGateCount();
 
   return veloByteData;
 }
@@ -354,14 +230,27 @@ void NodeEditor::mergeJsonData(const QByteArray& jsonData, const bool addBarrier
 
 bool NodeEditor::isStartGrid(const PrefabData& prefab)
 {
-  if (prefab.id > 0) {
-    return ((prefab.name == "DefaultStartGrid") ||
-            (prefab.name == "DefaultKDRAStartGrid") ||
-            (prefab.name == "DR1StartGrid") ||
-            (prefab.name == "PolyStartGrid") ||
-            (prefab.name == "MicroStartGrid"));
-  }
-  return false;
+  return (PrefabRegistry::computeCapabilities(prefab) & PrefabRegistry::StartGrid) != 0;
+}
+
+QVector<QVector<EditorObject*>> NodeEditor::findDuplicates(const int tolerance) const
+{
+  return DuplicateFinder(tolerance).findGroups(track->getObjects());
+}
+
+QVector<EditorObject*> NodeEditor::findNearestObjects(const QVector3D& position, const int count)
+{
+  return track->getSpatialIndex().findNearest(position, count);
+}
+
+QVector<EditorObject*> NodeEditor::findObjectsInBox(const QVector3D& min, const QVector3D& max)
+{
+  return track->getSpatialIndex().findInBox(min, max);
+}
+
+QVector<EditorObject*> NodeEditor::findObjectsInRadius(const QVector3D& center, const float radius)
+{
+  return track->getSpatialIndex().findInRadius(center, radius);
 }
 
 Track* NodeEditor::getTrack() const
@@ -372,6 +261,7 @@ Track* NodeEditor::getTrack() const
 void NodeEditor::setTrack(Track* newTrack)
 {
   track = newTrack;
+  searchPlan.reset();
 }
 
 QTreeView& NodeEditor::getTreeView() const
@@ -398,6 +288,9 @@ void NodeEditor::setSearchResult(const int cacheId, const QVector<EditorObject*>
 {
   searchCacheId = cacheId;
   searchResult = value;
+
+  // We do not know where the result came from, so it can not be kept up to date
+  searchPlan.reset();
 }
 
 int NodeEditor::getSearchCacheId() const
@@ -411,8 +304,10 @@ void NodeEditor::setFilterMarks()
     return;
 
   foreach(EditorObject* item, searchResult) {
-    item->setFilterMarked();
+    setFilterMark(item, true);
   }
+
+  filterMarksSet = true;
 }
 
 FilterProxyModel& NodeEditor::getFilteredModel()
@@ -447,23 +342,19 @@ bool NodeEditor::isModified()
 
 const PrefabData NodeEditor::getPrefabData(const uint id) const
 {
-  for (QVector<PrefabData>::const_iterator i = track->getAvailablePrefabs().begin(); i != track->getAvailablePrefabs().end(); ++i)
-    if (i->id == id)
-      return *i;
-
-  return PrefabData();
+  return track->getPrefabRegistry().get(id);
 }
 
 QString NodeEditor::getPrefabDesc(const uint id) const
 {
-  for (QVector<PrefabData>::const_iterator i = track->getAvailablePrefabs().begin(); i != track->getAvailablePrefabs().end(); ++i)
-    if (i->id == id)
-      return i->name + " (" + i->type + ")";
+  const PrefabData* prefab = track->getPrefabRegistry().find(id);
+  if (prefab == nullptr)
+    return "";
 
-  return "";
+  return prefab->name + " (" + prefab->type + ")";
 }
 
-QVector<PrefabData> NodeEditor::getAllPrefabData() const
+const QVector<PrefabData>& NodeEditor::getAllPrefabData() const
 {
   return track->getAvailablePrefabs();
 }
@@ -485,11 +376,11 @@ QVector<PrefabData> NodeEditor::getPrefabsInUse(bool includeNonEditable) const
     foreach(EditorObject* splineObject, object->getSplineObjects())
     {
       if (includeNonEditable || splineObject->isEditable())
-        prefabMap.insert(splineObject->getData().id, splineObject->getData());
+        prefabMap.insert(splineObject->getId(), splineObject->getData());
     }
 
     if (includeNonEditable || object->isEditable())
-      prefabMap.insert(object->getData().id, object->getData());
+      prefabMap.insert(object->getId(), object->getData());
   }
 
   QVector<PrefabData> prefabsInUse;
@@ -514,9 +405,8 @@ uint NodeEditor::getSceneId() const
 uint NodeEditor::replacePrefabs(const QModelIndex &searchIndex, const uint fromPrefabId, const uint toPrefabId, const QVector3D scaling)
 {
   // Search for prefabs that match the fromPrefabId and replace them with the toPrefabId
-  NodeFilter replaceIdFilter(FilterTypes::Object, FilterMethods::Is, int(fromPrefabId));
-  QVector<NodeFilter*> replaceFilterList;
-  replaceFilterList.append(&replaceIdFilter);
+  QVector<SearchFilter> replaceFilterList;
+  replaceFilterList.append(SearchFilter(FilterTypes::Object, FilterMethods::Is, int(fromPrefabId)));
 
   // Return the amount of prefabs we replaced
   return replacePrefabs(search(editorModel->itemsFromIndex(searchIndex), replaceFilterList), fromPrefabId, toPrefabId, scaling);
@@ -526,9 +416,8 @@ uint NodeEditor::replacePrefabs(const QModelIndex &searchIndex, const uint fromP
 uint NodeEditor::replacePrefabs(const QModelIndexList &searchIndexList, const uint fromPrefabId, const uint toPrefabId, const QVector3D scaling)
 {
   // Search for prefabs that match the fromPrefabId and replace them with the toPrefabId
-  NodeFilter replaceIdFilter(FilterTypes::Object, FilterMethods::Is, int(fromPrefabId));
-  QVector<NodeFilter*> replaceFilterList;
-  replaceFilterList.append(&replaceIdFilter);
+  QVector<SearchFilter> replaceFilterList;
+  replaceFilterList.append(SearchFilter(FilterTypes::Object, FilterMethods::Is, int(fromPrefabId)));
 
   // Return the amount of prefabs we replaced
   return replacePrefabs(search(editorModel->itemsFromIndexList(searchIndexList), replaceFilterList), fromPrefabId, toPrefabId, scaling);
@@ -964,7 +853,11 @@ uint NodeEditor::transformPrefab(const QVector<EditorObject*>& objects, const To
 
   case Mirror: {
     foreach(EditorObject* object, objects) {
-      EditorObject* duplicate = getObjectByIndex(duplicateObject(object));
+      const EditorModelItem* duplicateItem = editorModel->itemFromIndex(duplicateObject(object));
+      if (duplicateItem == nullptr || !duplicateItem->hasObject())
+        continue;
+
+      EditorObject* duplicate = duplicateItem->getObject();
       duplicate->setPosition(duplicate->getPositionVector() * QVector3D(-1, 1, -1));
       //object->setRotation(object->getRotationQuaterion() * QQuaternion::fromEulerAngles(0, 180, 0));
       count++;
@@ -992,98 +885,199 @@ void NodeEditor::resetStartGates()
   }
 }
 
-QVector<EditorObject*> NodeEditor::search(const QVector<EditorObject*>& searchItems, const QVector<NodeFilter*>& filterList) {
-  qDebug() << "NodeEditor::search called.";
-  QVector<EditorObject*> initialMatchList = searchItems;
-  QVector<EditorObject*> matchList = searchItems;
+void NodeEditor::runSearch(const int cacheId, const QVector<SearchFilter>& filterList)
+{
+  // Everything gets evaluated right now, so older changes are of no interest
+  track->getStore().takeChangedSlots();
 
-  if (matchList.count() == 0 || filterList.count() == 0)
-    return matchList;
+  // The same plan finds the result now and re-checks edited objects later.
+  // setSearchResult() would drop the plan again, so the result is assigned here.
+  const TrackStatistics statistics(track->getStore());
+  searchPlan.reset(new FilterPlan(filterList, &statistics));
+  searchCacheId = cacheId;
+  searchResult = search(track->getObjects(), filterList, *searchPlan);
 
-  if (!(filterList.count() == 1 && filterList.first()->getFilterType() == FilterTypes::CustomIndex)) {
+  searchPlanCustomOnly = (filterList.count() == 1 &&
+                          filterList.first().getType() == FilterTypes::CustomIndex);
 
-    // One does not simply apply the filter, but does it in a certain order :)
-    applyFilterToList(matchList, filterList, FilterTypes::Object);
-    if (matchList.count() == 0)
-      return matchList;
+  searchResultSlots.clear();
+  foreach(EditorObject* object, searchResult)
+    searchResultSlots.insert(object->getSlot(), object);
 
-    applyFilterToList(matchList, filterList, FilterTypes::PositionR);
-    if (matchList.count() == 0)
-      return matchList;
+  pinnedSearchSlots.clear();
+  foreach(const SearchFilter& filter, filterList) {
+    if (filter.getType() != FilterTypes::CustomIndex)
+      continue;
 
-    applyFilterToList(matchList, filterList, FilterTypes::PositionB);
-    if (matchList.count() == 0)
-      return matchList;
+    foreach(const QModelIndex& index, filter.getCustomIndexList()) {
+      EditorObject* object = getObjectByIndex(index);
+      if (object != nullptr && searchResultSlots.value(object->getSlot()) == object)
+        pinnedSearchSlots.insert(object->getSlot(), object);
+    }
+  }
+}
 
-    applyFilterToList(matchList, filterList, FilterTypes::PositionG);
-    if (matchList.count() == 0)
-      return matchList;
+void NodeEditor::refreshSearch()
+{
+  // An open edit checks its changes once it ends
+  if (editDepth > 0)
+    return;
 
-    applyFilterToList(matchList, filterList, FilterTypes::AnyPosition);
-    if (matchList.count() == 0)
-      return matchList;
+  refreshSearch(track->getStore().takeChangedSlots());
+}
 
-    applyFilterToList(matchList, filterList, FilterTypes::RotationW);
-    if (matchList.count() == 0)
-      return matchList;
+void NodeEditor::refreshSearch(const QVector<int>& changedSlots)
+{
+  TrackStore& store = track->getStore();
+  if (searchPlan.isNull() || changedSlots.isEmpty())
+    return;
 
-    applyFilterToList(matchList, filterList, FilterTypes::RotationX);
-    if (matchList.count() == 0)
-      return matchList;
+  // Objects of the old result may be gone already, so they are only compared and never touched
+  const auto isAlive = [&store](const int slot, const EditorObject* object) {
+    return store.isLive(slot) && store.getObject(slot) == object;
+  };
 
-    applyFilterToList(matchList, filterList, FilterTypes::RotationY);
-    if (matchList.count() == 0)
-      return matchList;
+  // A duplicate can stop being one if the other object is edited, so these are always searched in full
+  if (searchPlan->dependsOnAllObjects()) {
+    QVector<EditorObject*> result;
+    if (!searchPlanCustomOnly)
+      result = searchPlan->apply(track->getObjects());
 
-    applyFilterToList(matchList, filterList, FilterTypes::RotationZ);
-    if (matchList.count() == 0)
-      return matchList;
+    QHash<int, EditorObject*> resultSlots;
+    foreach(EditorObject* object, result)
+      resultSlots.insert(object->getSlot(), object);
 
-    applyFilterToList(matchList, filterList, FilterTypes::AnyRotation);
-    if (matchList.count() == 0)
-      return matchList;
+    for (QHash<int, EditorObject*>::iterator pinned = pinnedSearchSlots.begin(); pinned != pinnedSearchSlots.end();) {
+      if (!isAlive(pinned.key(), pinned.value())) {
+        pinned = pinnedSearchSlots.erase(pinned);
+        continue;
+      }
+      if (!resultSlots.contains(pinned.key())) {
+        result.append(pinned.value());
+        resultSlots.insert(pinned.key(), pinned.value());
+      }
+      ++pinned;
+    }
 
-    applyFilterToList(matchList, filterList, FilterTypes::AnyScaling);
-    if (matchList.count() == 0)
-      return matchList;
+    for (QHash<int, EditorObject*>::const_iterator old = searchResultSlots.constBegin(); old != searchResultSlots.constEnd(); ++old) {
+      if (resultSlots.value(old.key()) != old.value() && isAlive(old.key(), old.value()))
+        setSearchMark(old.value(), false);
+    }
+    for (QHash<int, EditorObject*>::const_iterator found = resultSlots.constBegin(); found != resultSlots.constEnd(); ++found) {
+      if (searchResultSlots.value(found.key()) != found.value())
+        setSearchMark(found.value(), true);
+    }
 
-    applyFilterToList(matchList, filterList, FilterTypes::ScalingR);
-    if (matchList.count() == 0)
-      return matchList;
+    searchResult.swap(result);
+    searchResultSlots.swap(resultSlots);
+    return;
+  }
 
-    applyFilterToList(matchList, filterList, FilterTypes::ScalingB);
-    if (matchList.count() == 0)
-      return matchList;
+  QSet<EditorObject*> leavingObjects;
+  bool joined = false;
 
-    applyFilterToList(matchList, filterList, FilterTypes::ScalingG);
-    if (matchList.count() == 0)
-      return matchList;
+  foreach(const int slot, changedSlots) {
+    // Only the top level objects of the track are searched
+    EditorObject* object = store.isLive(slot) ? store.getObject(slot) : nullptr;
+    if (object != nullptr && object->getParentObject() != nullptr)
+      object = nullptr;
 
-    applyFilterToList(matchList, filterList, FilterTypes::GateNo);
-    if (matchList.count() == 0)
-      return matchList;
+    EditorObject* previous = searchResultSlots.value(slot, nullptr);
+    const bool match = object != nullptr &&
+                       ((previous == object && pinnedSearchSlots.value(slot) == object) ||
+                        (!searchPlanCustomOnly && searchPlan->accepts(object)));
+
+    if (previous != nullptr && (previous != object || !match)) {
+      leavingObjects.insert(previous);
+      pinnedSearchSlots.remove(slot);
+      searchResultSlots.remove(slot);
+
+      if (previous == object)
+        setSearchMark(object, false);
+    }
+
+    if (match && previous != object) {
+      joined = true;
+      searchResultSlots.insert(slot, object);
+      setSearchMark(object, true);
+    }
+  }
+
+  if (leavingObjects.isEmpty() && !joined)
+    return;
+
+  // The result stays in track order like after a full search, the increasing transforms depend on it
+  QVector<EditorObject*> result;
+  result.reserve(searchResultSlots.count());
+  foreach(EditorObject* object, track->getObjects()) {
+    if (searchResultSlots.value(object->getSlot()) == object)
+      result.append(object);
+  }
 
-    applyFilterToList(matchList, filterList, FilterTypes::IsOnSpline);
+  // Manually selected spline children are no track objects, they keep their place behind them
+  foreach(EditorObject* object, searchResult) {
+    if (!leavingObjects.contains(object) && object->getParentObject() != nullptr)
+      result.append(object);
+  }
+
+  searchResult.swap(result);
+}
+
+void NodeEditor::setSearchMark(EditorObject* object, const bool value)
+{
+  // Marks are only shown while the filter is enabled
+  if (!filterMarksSet)
+    return;
+
+  setFilterMark(object, value);
+}
+
+void NodeEditor::setFilterMark(EditorObject* object, const bool value)
+{
+  // Through the model, so the mark summaries of the tree and the filtered view stay up to date
+  EditorModelItem* item = object->getParentModelItem();
+  if (item != nullptr && item->getObject() == object)
+    editorModel->setFilterMarked(item, value);
+  else
+    object->setFilterMarked(value);
+}
+
+QVector<EditorObject*> NodeEditor::search(const QVector<EditorObject*>& searchItems, const QVector<SearchFilter>& filterList) {
+  qDebug() << "NodeEditor::search called.";
+  if (searchItems.count() == 0 || filterList.count() == 0)
+    return searchItems;
+
+  // All filters are compiled into one plan and checked in a single pass over the objects
+  const TrackStatistics statistics(searchItems.first()->getStore());
+  const FilterPlan plan(filterList, &statistics);
+  return search(searchItems, filterList, plan);
+}
+
+QVector<EditorObject*> NodeEditor::search(const QVector<EditorObject*>& searchItems, const QVector<SearchFilter>& filterList, const FilterPlan& plan) {
+  QVector<EditorObject*> matchList = searchItems;
+
+  if (matchList.count() == 0 || filterList.count() == 0)
+    return matchList;
+
+  if (!(filterList.count() == 1 && filterList.first().getType() == FilterTypes::CustomIndex)) {
+    matchList = plan.apply(matchList);
     if (matchList.count() == 0)
       return matchList;
-
-    applyFilterToList(matchList, filterList, FilterTypes::IsDublicate, &initialMatchList);
   }
 
   // If the custom index filter is the only filter, we clear the matchList
   if (filterList.count() == 1 &&
-      filterList.first() != nullptr &&
-      filterList.first()->getFilterType() == FilterTypes::CustomIndex)
+      filterList.first().getType() == FilterTypes::CustomIndex)
     matchList.clear();
 
   // Add the custom indexes if they havent been set yet
   bool matched = false;
-  foreach(NodeFilter* filter, filterList) {
+  foreach(const SearchFilter& filter, filterList) {
     // We only care about custom index filter
-    if (filter->getFilterType() != FilterTypes::CustomIndex)
+    if (filter.getType() != FilterTypes::CustomIndex)
       continue;
 
-    foreach(QModelIndex index, filter->getCustomIndexList()) {
+    foreach(QModelIndex index, filter.getCustomIndexList()) {
       // Check if an object with the custom index is already present
       matched = false;
       foreach(EditorObject* matchedItem, matchList) {
@@ -1114,11 +1108,11 @@ QVector<EditorObject*> NodeEditor::search(const QVector<EditorObject*>& searchIt
   return matchList;
 }
 
-//QVector<EditorObject*> NodeEditor::search(QModelIndex& index, QVector<NodeFilter*> filterList) {
+//QVector<EditorObject*> NodeEditor::search(QModelIndex& index, QVector<SearchFilter> filterList) {
 //  return search(findPrefabs(index), filterList);
 //}
 
-QVector<EditorObject*> NodeEditor::search(QList<EditorModelItem*> objects, QVector<NodeFilter*> filterList) {
+QVector<EditorObject*> NodeEditor::search(QList<EditorModelItem*> objects, const QVector<SearchFilter>& filterList) {
   QVector<EditorObject*> matchList;
   foreach(EditorModelItem* objectItem, objects) {
     EditorObject* object = objectItem->getObject();
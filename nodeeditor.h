@@ -13,15 +13,20 @@
 #include <QTreeView>
 #include <QTreeWidgetItem>
 #include <QQuaternion>
+#include <QScopedPointer>
+#include <QSet>
 #include <QVector3D>
 
 #include "track.h"
 
 #include "editormodel.h"
 #include "editorobject.h"
+#include "duplicatefinder.h"
 #include "exceptions.h"
+#include "filterplan.h"
 #include "filterproxymodel.h"
-#include "nodefilter.h"
+#include "searchfilter.h"
+#include "trackstatistics.h"
 #include "velodataparser.h"
 #include "velodb.h"
 
@@ -69,9 +74,13 @@ public:
   void                        deleteNode(const QModelIndex &index) const;
   QModelIndex                 duplicateObject(EditorObject* sourceObject);
   void                        endNodeEdit();
-  QByteArray*                 exportAsJsonData();
-  QVector<PrefabData>         getAllPrefabData() const;
+  QByteArray                  exportAsJsonData();
+  const QVector<PrefabData>&  getAllPrefabData() const;
   FilterProxyModel&           getFilteredModel();
+  QVector<QVector<EditorObject*>> findDuplicates(const int tolerance = 0) const;
+  QVector<EditorObject*>      findNearestObjects(const QVector3D& position, const int count);
+  QVector<EditorObject*>      findObjectsInBox(const QVector3D& min, const QVector3D& max);
+  QVector<EditorObject*>      findObjectsInRadius(const QVector3D& center, const float radius);
   EditorObject*               getObjectByIndex(const QModelIndex index);
   const PrefabData            getPrefabData(const uint id) const;
   QString                     getPrefabDesc(const uint id) const;
@@ -84,6 +93,7 @@ public:
   TrackData&                  getTrackData();
   QTreeView&                  getTreeView() const;
   bool                        isModified();
+  void                        refreshSearch();
   void                        mergeJsonData(const QByteArray& jsonData, const bool addBarriers, const bool addGates);
   uint                        replacePrefabs(const QModelIndex& searchIndex, const uint fromPrefabId, const uint toPrefabId, const QVector3D scaling = QVector3D(1, 1, 1));
   uint                        replacePrefabs(const QModelIndexList& searchIndexList, const uint fromPrefabId, const uint toPrefabId, const QVector3D scaling = QVector3D(1, 1, 1));
@@ -93,9 +103,10 @@ public:
   uint                        transformPrefab(const QVector<EditorObject*>& prefabs, const ToolTypes toolType, const QVariant &value, const ToolTypeTargets target = ToolTypeTargets::RGB, const bool byPercent = false);
   void                        resetFinishGates();  
   void                        resetStartGates();
-  QVector<EditorObject*>      search(const QVector<EditorObject*>&  index, const QVector<NodeFilter*>& filterList);
-  //QVector<EditorObject*>      search(QModelIndex& index, QVector<NodeFilter*> filterList);
-  QVector<EditorObject*>      search(QList<EditorModelItem*> items, QVector<NodeFilter*> filterList);
+  void                        runSearch(const int cacheId, const QVector<SearchFilter>& filterList);
+  QVector<EditorObject*>      search(const QVector<EditorObject*>&  index, const QVector<SearchFilter>& filterList);
+  //QVector<EditorObject*>      search(QModelIndex& index, QVector<SearchFilter> filterList);
+  QVector<EditorObject*>      search(QList<EditorModelItem*> items, const QVector<SearchFilter>& filterList);
   void                        setFilterMarks();
   void                        setSearchFilter(const bool enable);
   void                        setSearchResult(const int cacheId, const QVector<EditorObject*>& value);
@@ -110,23 +121,32 @@ public:
 private:
   uint sceneId;
   int searchCacheId = INT_MIN;
-  bool editStarted = false;
+  int editDepth = 0;
 
   Track* track;
   QTreeView* treeView;
   EditorModel* editorModel;
   FilterProxyModel filteredModel;  
   QVector<EditorObject*> searchResult;
+  bool filterMarksSet = false;
 
-  float lastScrollbarPos;
-  QVector<bool> lastTreeExpansionStates;
+  // The plan of the last full search, edits re-check only the objects they touched against it
+  QScopedPointer<FilterPlan> searchPlan;
+  bool searchPlanCustomOnly = false;
+  QHash<int, EditorObject*> searchResultSlots;
+  // Results that came from a manual selection, they stay until they are removed
+  QHash<int, EditorObject*> pinnedSearchSlots;
+
+  void                        refreshSearch(const QVector<int>& changedSlots);
+  QVector<EditorObject*>      search(const QVector<EditorObject*>& searchItems, const QVector<SearchFilter>& filterList, const FilterPlan& plan);
+  void                        setFilterMark(EditorObject* object, const bool value);
+  void                        setSearchMark(EditorObject* object, const bool value);
 
   uint nodeCount = 0;
   uint prefabCount = 0;
   uint splineCount = 0;
   uint gateCount = 0;  
 
-  void applyFilterToList(QVector<EditorObject*>& items, const QVector<NodeFilter*>& filter, const FilterTypes filterType, const QVector<EditorObject*>* initalItems = nullptr);
   bool containsModifiedNode() const;
 };
 
@@ -12,33 +12,39 @@ NodeFilter::NodeFilter(const FilterTypes filterType, const FilterMethods filterM
 
 }
 
-NodeFilter::NodeFilter(const FilterTypes filterType, const FilterMethods filterMethod, const int filterValue, const QString filterDisplayValue, const QModelIndex customIndex, QObject *parent)
+NodeFilter::NodeFilter(const FilterTypes filterType, const FilterMethods filterMethod, const int filterValue, const QString filterDisplayValue, const QModelIndex customIndex, QObject *parent) :
+  NodeFilter(SearchFilter(filterType, filterMethod, filterValue, customIndex), filterDisplayValue, parent)
+{
+
+}
+
+NodeFilter::NodeFilter(const SearchFilter& filter, const QString filterDisplayValue, QObject *parent) :
+  filter(filter)
 {  
   this->setMargin(0);
   this->setSpacing(0);
   this->setStretch(-1, 1);
   this->setParent(parent);
-  this->filterType = filterType;
-  this->filterMethod = filterMethod;
-  this->filterValue = filterValue;
   this->filterDisplayValue = filterDisplayValue;
 
-  if (filterType == FilterTypes::Object)
-    this->filterMethod = FilterMethods::Is;
+  const FilterTypes filterType = filter.getType();
+  const int filterValue = filter.getValue();
 
-  if (filterType == FilterTypes::CustomIndex) {
+  if (filterType == FilterTypes::CustomIndex)
     this->filterDisplayValue = "";
-    if (customIndex.isValid())
-      customIndexList.append(customIndex);
-  }
 
   // Calculate the display value if it has not been provided
   if (filterType != FilterTypes::IsOnSpline &&
       filterType != FilterTypes::IsDublicate &&
       filterType != FilterTypes::CustomIndex &&
+      filterType != FilterTypes::Query &&
       filterDisplayValue == "")
     this->filterDisplayValue = QString("%1").arg(filterValue);
 
+  // Duplicates only show their tolerance, if they have one
+  if (filterType == FilterTypes::IsDublicate && filterValue > 0 && filterDisplayValue == "")
+    this->filterDisplayValue = QString("± %1").arg(filterValue);
+
   // Create controls
   createFilterLabel();
   updateFilterLabel();
@@ -51,13 +57,12 @@ NodeFilter::NodeFilter(const FilterTypes filterType, const FilterMethods filterM
 
 void NodeFilter::addCustomIndex(const QModelIndex &index)
 {
-  if (filterType == FilterTypes::CustomIndex && index.isValid())
-    customIndexList.append(index);
+  filter.addCustomIndex(index);
 }
 
-bool NodeFilter::containsCustomIndex(const QModelIndex &index)
+bool NodeFilter::containsCustomIndex(const QModelIndex &index) const
 {
-  return customIndexList.contains(index);
+  return filter.containsCustomIndex(index);
 }
 
 void NodeFilter::createFilterLabel()
@@ -100,22 +105,27 @@ void NodeFilter::destroy()
 
 QModelIndexList NodeFilter::getCustomIndexList() const
 {
-  return customIndexList;
+  return filter.getCustomIndexList();
+}
+
+const SearchFilter& NodeFilter::getFilter() const
+{
+  return filter;
 }
 
 FilterTypes NodeFilter::getFilterType() const
 {
-  return filterType;
+  return filter.getType();
 }
 
 FilterMethods NodeFilter::getFilterMethod() const
 {
-  return filterMethod;
+  return filter.getMethod();
 }
 
 int NodeFilter::getFilterValue() const
 {
-  return filterValue;
+  return filter.getValue();
 }
 
 QString NodeFilter::getFilterDisplayValue() const
@@ -131,7 +141,7 @@ void NodeFilter::removeButtonPushed()
 
 void NodeFilter::removeCustomIndex(const QModelIndex& index)
 {
-  customIndexList.removeOne(index);
+  filter.removeCustomIndex(index);
 }
 
 void NodeFilter::setFilterDisplayValue(const QString value)
@@ -142,19 +152,19 @@ void NodeFilter::setFilterDisplayValue(const QString value)
 
 void NodeFilter::setFilterMethod(const FilterMethods &value)
 {
-  filterMethod = value;
+  filter.setMethod(value);
   updateFilterLabel();
 }
 
 void NodeFilter::setFilterType(const FilterTypes &value)
 {
-  filterType = value;
+  filter.setType(value);
   updateFilterLabel();
 }
 
 void NodeFilter::setFilterValue(const int value)
 {
-  filterValue = value;
+  filter.setValue(value);
   updateFilterLabel();
 }
 
@@ -188,6 +198,7 @@ FilterTypes NodeFilter::getFilterTypeByDescription(const QString descrption)
   else if (desc.indexOf(tr("is on spline")) > -1) { return FilterTypes::IsOnSpline; }
   else if (desc.indexOf(tr("is dublicate")) > -1) { return FilterTypes::IsDublicate; }
   else if (desc.indexOf(tr("manual selection")) > -1) { return FilterTypes::IsDublicate; }
+  else if (desc.indexOf(tr("query")) > -1) { return FilterTypes::Query; }
   else { return FilterTypes::Object; }
 }
 
@@ -213,6 +224,7 @@ QString NodeFilter::getDescriptionFromFilterType(const FilterTypes type)
   case FilterTypes::GateNo: description = tr("Gate No."); break;
   case FilterTypes::IsOnSpline: description = tr("is on Spline"); break;
   case FilterTypes::IsDublicate: description = tr("is dublicate"); break;
+  case FilterTypes::Query: description = tr("Query"); break;
   case FilterTypes::CustomIndex: description = tr("Manual Selection"); break;
   }
 
@@ -234,11 +246,13 @@ QString NodeFilter::getFilterMethodDescription(const FilterMethods method)
 void NodeFilter::updateFilterLabel()
 {
   // Build the description string for the label
+  const FilterTypes filterType = filter.getType();
   QString method = "";
   if (filterType != FilterTypes::IsOnSpline &&
       filterType != FilterTypes::IsDublicate &&
-      filterType != FilterTypes::CustomIndex)
-    method = getFilterMethodDescription(filterMethod);
+      filterType != FilterTypes::CustomIndex &&
+      filterType != FilterTypes::Query)
+    method = getFilterMethodDescription(filter.getMethod());
   const QString filterDesc = QString("%1 %2 %3")
       .arg(getDescriptionFromFilterType(filterType))
       .arg(method)
@@ -13,33 +13,7 @@
 #include <QVariant>
 #include <QWidget>
 
-enum FilterTypes {
-  Object      = 0,
-  AnyPosition = 1,
-  PositionR   = 2,
-  PositionG   = 3,
-  PositionB   = 4,
-  AnyRotation = 5,
-  RotationW   = 6,
-  RotationX   = 7,
-  RotationY   = 8,
-  RotationZ   = 9,
-  AnyScaling  = 10,
-  ScalingR    = 11,
-  ScalingG    = 12,
-  ScalingB    = 13,
-  GateNo      = 14,
-  IsDublicate = 15,
-  IsOnSpline  = 16,
-  CustomIndex = 255
-};
-
-enum FilterMethods {
-  Contains = 0,
-  Is = 1,
-  SmallerThan = 2,
-  BiggerThan = 3,
-};
+#include "searchfilter.h"
 
 class NodeFilter : public QHBoxLayout
 {
@@ -49,14 +23,16 @@ public:
   explicit NodeFilter(const QModelIndex& customIndex, QObject *parent = nullptr);
   explicit NodeFilter(const FilterTypes filterType, const FilterMethods filterMethod, const int filterValue, const QString filterDisplayValue = "", QObject *parent = nullptr);
   explicit NodeFilter(const FilterTypes filterType, const FilterMethods filterMethod, const int filterValue, const QString filterDisplayValue, const QModelIndex customIndex, QObject *parent = nullptr);
+  explicit NodeFilter(const SearchFilter& filter, const QString filterDisplayValue, QObject *parent = nullptr);
 
   void addCustomIndex(const QModelIndex& index);
 
-  bool containsCustomIndex(const QModelIndex& index);
+  bool containsCustomIndex(const QModelIndex& index) const;
 
   void destroy();    
 
   QModelIndexList getCustomIndexList() const;
+  const SearchFilter& getFilter() const;
   FilterTypes getFilterType() const;
   FilterMethods getFilterMethod() const;
   int getFilterValue() const;
@@ -81,13 +57,10 @@ private slots:
   void removeButtonPushed();
 
 private:
-  FilterTypes filterType;
-  FilterMethods filterMethod;
+  SearchFilter filter;
   QPushButton* removeFilterButton;
   QLabel* filterLabel;
-  int filterValue;
   QString filterDisplayValue;
-  QModelIndexList customIndexList;
 
   void createFilterLabel();
   void createRemoveButton();
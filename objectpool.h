@@ -0,0 +1,105 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <QVector>
+
+// Hands out objects from large chunks instead of allocating each one on its own.
+// Destroyed objects leave a hole that is reused by the next create, clear() destroys
+// everything that is still alive and returns the chunks in one go.
+template<typename T, int ChunkSize = 1024>
+class ObjectPool
+{
+public:
+  ObjectPool() = default;
+  ~ObjectPool() { clear(); }
+
+  template<typename... Args>
+  T* create(Args&&... args)
+  {
+    Slot* slot = nextFreeSlot();
+    T* object;
+    try {
+      object = new (&slot->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      freeSlots.append(slot);
+      throw;
+    }
+    slot->used = true;
+    liveCount++;
+    return object;
+  }
+
+  void destroy(T* object)
+  {
+    if (object == nullptr)
+      return;
+
+    // The storage is the first member of a slot, so the object address is the slot address
+    Slot* slot = reinterpret_cast<Slot*>(object);
+    if (!slot->used)
+      return;
+
+    slot->used = false;
+    object->~T();
+    freeSlots.append(slot);
+    liveCount--;
+  }
+
+  void clear()
+  {
+    // A destructor may destroy other pooled objects (e.g. children), those are skipped once we get to them
+    for (int chunk = 0; chunk < chunks.count(); ++chunk) {
+      const int slotCount = (chunk == chunks.count() - 1) ? usedInLastChunk : ChunkSize;
+      for (int i = 0; i < slotCount; ++i) {
+        Slot& slot = chunks.at(chunk)[i];
+        if (!slot.used)
+          continue;
+
+        slot.used = false;
+        reinterpret_cast<T*>(&slot.storage)->~T();
+      }
+    }
+
+    foreach(Slot* chunk, chunks)
+      delete[] chunk;
+
+    chunks.clear();
+    freeSlots.clear();
+    usedInLastChunk = ChunkSize;
+    liveCount = 0;
+  }
+
+  int count() const { return liveCount; }
+
+private:
+  Q_DISABLE_COPY(ObjectPool)
+
+  struct Slot
+  {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    bool used = false;
+  };
+
+  QVector<Slot*> chunks;
+  QVector<Slot*> freeSlots;
+  int usedInLastChunk = ChunkSize;
+  int liveCount = 0;
+
+  Slot* nextFreeSlot()
+  {
+    if (!freeSlots.isEmpty())
+      return freeSlots.takeLast();
+
+    if (usedInLastChunk == ChunkSize) {
+      chunks.append(new Slot[ChunkSize]);
+      usedInLastChunk = 0;
+    }
+
+    return &chunks.last()[usedInLastChunk++];
+  }
+};
+
+#endif // OBJECTPOOL_H
@@ -13,6 +13,14 @@ OpenTrackDialog::OpenTrackDialog(QWidget *parent, VeloDb* productionDb, VeloDb*
 
   ui->setupUi(this);
 
+  trackCatalogModel = new TrackCatalogModel(this);
+  trackCatalogProxyModel = new QSortFilterProxyModel(this);
+  trackCatalogProxyModel->setSourceModel(trackCatalogModel);
+  trackCatalogProxyModel->setSortCaseSensitivity(Qt::CaseInsensitive);
+  ui->trackListTreeView->setModel(trackCatalogProxyModel);
+  ui->trackListTreeView->sortByColumn(TrackTreeColumns::NameColumn, Qt::AscendingOrder);
+  ui->trackListTreeView->header()->setSectionResizeMode(TrackTreeColumns::NameColumn, QHeaderView::ResizeToContents);
+
   if (productionDb != nullptr && productionDb->isValid())
     ui->databaseComboBox->insertItem(0, tr("Production"));
 
@@ -34,24 +42,31 @@ OpenTrackDialog::OpenTrackDialog(QWidget *parent, VeloDb* productionDb, VeloDb*
 
 OpenTrackDialog::~OpenTrackDialog()
 {
+  cancelIndexing();
+  cancelLoading();
   delete ui;
 }
 
+void OpenTrackDialog::showEvent(QShowEvent* event)
+{
+  QDialog::showEvent(event);
+
+  // Only reloads the catalog, if the database changed since we have shown it the last time
+  loadDatabase(getSelectedDatabase());
+}
+
 void OpenTrackDialog::on_databaseComboBox_currentIndexChanged(const QString &arg1)
 {
-  ui->trackListTreeWidget->clear();
-
-  VeloDb* selectedDb = nullptr;
-  if (arg1 == tr("Production")) {
-    selectedDb = productionDb;
-  } else if (arg1 == tr("Beta")) {
-    selectedDb = betaDb;
-  } else if (arg1 == tr("Custom")) {
-    selectedDb = customDb;
-  }
+  Q_UNUSED(arg1)
 
-  if (selectedDb == nullptr)
+  VeloDb* selectedDb = getSelectedDatabase();
+  if (selectedDb == nullptr) {
+    cancelIndexing();
+    cancelLoading();
+    trackCatalogModel->clear();
+    shownDatabase = nullptr;
     return;
+  }
 
   QSettings settings("settings.ini", QSettings::IniFormat);
   settings.setValue("general/lastDatabaseIndex", ui->databaseComboBox->currentIndex());
@@ -62,46 +77,195 @@ void OpenTrackDialog::on_databaseComboBox_currentIndexChanged(const QString &arg
 TrackData OpenTrackDialog::getSelectedTrack() const
 {
   TrackData track;
-  QList<QTreeWidgetItem*> selectedTableItems = ui->trackListTreeWidget->selectedItems();
-  if (selectedTableItems.size() > 0)
-    track = selectedTableItems.first()->data(TrackTreeColumns::NameColumn, Qt::UserRole).value<TrackData>();
+  QModelIndexList selectedRows = ui->trackListTreeView->selectionModel()->selectedRows(TrackTreeColumns::NameColumn);
+  if (selectedRows.size() > 0)
+    track = selectedRows.first().data(Qt::UserRole).value<TrackData>();
 
   return track;
 }
 
+void OpenTrackDialog::onCatalogLoadingFinished()
+{
+  if (sender() != catalogLoader)
+    return;
+
+  // Hand the catalog to the database, so the next time we can skip loading if nothing changed
+  loadingDatabase->setTracks(trackCatalogModel->getTracks(), loadingStamp);
+  shownDatabase = loadingDatabase;
+  shownCatalogRevision = loadingDatabase->getTrackCatalogRevision();
+
+  cancelLoading();
+  startIndexing(shownDatabase);
+}
+
+void OpenTrackDialog::onCatalogLoadingFailed(const QString& errorMessage)
+{
+  if (sender() != catalogLoader)
+    return;
+
+  cancelLoading();
+  VeloToolkitException(errorMessage).Message();
+}
+
+void OpenTrackDialog::onCatalogTracksLoaded(const QVector<TrackData>& tracks)
+{
+  // Batches of a cancelled loader might still be queued, so we ignore everything but the current one
+  if (sender() != catalogLoader)
+    return;
+
+  trackCatalogModel->appendTracks(tracks);
+}
+
+void OpenTrackDialog::onIndexingFailed(const QString& errorMessage)
+{
+  if (sender() != indexer)
+    return;
+
+  // The index only adds a few columns, the catalog works without it
+  cancelIndexing();
+  qDebug() << "Could not update the track index:" << errorMessage;
+}
+
+void OpenTrackDialog::onIndexingFinished(const int updatedTracks, const int removedTracks)
+{
+  if (sender() != indexer)
+    return;
+
+  VeloDb* database = indexingDatabase;
+  cancelIndexing();
+
+  if (database == shownDatabase && (updatedTracks > 0 || removedTracks > 0))
+    loadSummaries(database);
+}
+
+void OpenTrackDialog::cancelIndexing()
+{
+  if (indexer == nullptr)
+    return;
+
+  indexer->cancel();
+  indexer->deleteLater();
+  indexer = nullptr;
+  indexingDatabase = nullptr;
+}
+
+void OpenTrackDialog::cancelLoading()
+{
+  if (catalogLoader == nullptr)
+    return;
+
+  catalogLoader->cancel();
+  catalogLoader->deleteLater();
+  catalogLoader = nullptr;
+  loadingDatabase = nullptr;
+}
+
+VeloDb* OpenTrackDialog::getSelectedDatabase() const
+{
+  const QString selectedDbStr = ui->databaseComboBox->currentText();
+  if (selectedDbStr == tr("Production"))
+    return productionDb;
+
+  if (selectedDbStr == tr("Beta"))
+    return betaDb;
+
+  if (selectedDbStr == tr("Custom"))
+    return customDb;
+
+  return nullptr;
+}
+
 void OpenTrackDialog::loadDatabase(VeloDb* database)
 {
   if (database == nullptr)
     return;
 
-  database->queryAll();
+  // The catalog of this database is still being loaded
+  if (catalogLoader != nullptr && loadingDatabase == database)
+    return;
+
+  // The scenes are few and needed for the scene column, so we read them right away
+  try {
+    database->refreshSettings();
+  } catch (VeloToolkitException& e) {
+    e.Message();
+  }
 
-  int row = 0;
-  foreach(TrackData track, database->getTracks()) {
-    //qDebug() << "......... track:" << track;
-    QTreeWidgetItem* trackItem = new QTreeWidgetItem();
-    trackItem->setText(0, track.name);
+  // Use the cached catalog if the database file didn't change since it was read
+  if (database->isTrackCatalogCurrent()) {
+    if (shownDatabase == database && shownCatalogRevision == database->getTrackCatalogRevision())
+      return;
 
-    foreach(SceneData scene, database->getScenes()) {
-      if (scene.id == track.sceneId) {
-        trackItem->setText(TrackTreeColumns::SceneColumn, scene.title);
-        break;
-      }
-    }
+    cancelLoading();
+    trackCatalogModel->clear(database);
+    trackCatalogModel->appendTracks(database->getTracks());
+    shownDatabase = database;
+    shownCatalogRevision = database->getTrackCatalogRevision();
+    startIndexing(database);
+    return;
+  }
 
-    QVariant var;
-    var.setValue(track);
-    trackItem->setData(TrackTreeColumns::NameColumn, Qt::UserRole, var);
+  cancelLoading();
+  trackCatalogModel->clear(database);
+  shownDatabase = nullptr;
 
-    ui->trackListTreeWidget->addTopLevelItem(trackItem);
-    row++;
+  try {
+    loadingStamp = database->readTrackCatalogStamp();
+  } catch (VeloToolkitException& e) {
+    e.Message();
+    return;
   }
 
-  QStringList labels;
-  labels << tr("Name") << tr("Scene");
-  ui->trackListTreeWidget->setHeaderLabels(labels);
-  ui->trackListTreeWidget->header()->setSectionResizeMode(TrackTreeColumns::NameColumn, QHeaderView::ResizeToContents);
+  // The tracks are read in the background and show up in batches while the dialog stays responsive
+  loadingDatabase = database;
+  catalogLoader = new TrackCatalogLoader(database->getDatabaseType(), database->getUserDbFilename(), this);
+  connect(catalogLoader, SIGNAL(tracksLoaded(QVector<TrackData>)), this, SLOT(onCatalogTracksLoaded(QVector<TrackData>)));
+  connect(catalogLoader, SIGNAL(loadingFinished()), this, SLOT(onCatalogLoadingFinished()));
+  connect(catalogLoader, SIGNAL(loadingFailed(QString)), this, SLOT(onCatalogLoadingFailed(QString)));
+  catalogLoader->start(QThread::LowPriority);
 }
 
+bool OpenTrackDialog::loadSummaries(VeloDb* database)
+{
+  try {
+    TrackIndex index(database->getUserDbFilename());
+    index.open();
+    trackCatalogModel->setSummaries(index.getSummaries());
+  } catch (VeloToolkitException& e) {
+    qDebug() << "Could not read the track index:" << QString(e);
+    return false;
+  }
+
+  return true;
+}
 
+void OpenTrackDialog::startIndexing(VeloDb* database)
+{
+  cancelIndexing();
 
+  // Whatever the index knew from the last time shows up right away
+  if (database == nullptr || !loadSummaries(database))
+    return;
+
+  // Without the prefabs gates can not be told apart, and unchanged tracks would keep the wrong counts
+  if (database->getPrefabRegistry()->count() == 0)
+    return;
+
+  // If the database did not change since the last complete run, every track would be hashed for nothing
+  const DatabaseFileStamp stamp = TrackIndex::readDatabaseFileStamp(database->getUserDbFilename());
+  try {
+    TrackIndex index(database->getUserDbFilename());
+    index.open();
+    if (index.readFileStamp() == stamp)
+      return;
+  } catch (VeloToolkitException& e) {
+    qDebug() << "Could not read the track index:" << QString(e);
+    return;
+  }
+
+  indexingDatabase = database;
+  indexer = new TrackIndexer(database->getUserDbFilename(), database->getPrefabRegistry(), stamp, this);
+  connect(indexer, SIGNAL(indexingFinished(int, int)), this, SLOT(onIndexingFinished(int, int)));
+  connect(indexer, SIGNAL(indexingFailed(QString)), this, SLOT(onIndexingFailed(QString)));
+  indexer->start(QThread::LowPriority);
+}
@@ -4,20 +4,19 @@
 #include <QDialog>
 #include <QDebug>
 #include <QSettings>
-#include <QTreeWidget>
+#include <QShowEvent>
+#include <QSortFilterProxyModel>
 
 #include "exceptions.h"
+#include "trackcatalogloader.h"
+#include "trackcatalogmodel.h"
+#include "trackindexer.h"
 #include "velodb.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class OpenTrackDialog; }
 QT_END_NAMESPACE
 
-enum TrackTreeColumns {
-  NameColumn = 0,
-  SceneColumn = 1
-};
-
 class OpenTrackDialog : public QDialog
 {
   Q_OBJECT
@@ -28,15 +27,38 @@ public:
 
   TrackData getSelectedTrack() const;
 
+protected:
+  void showEvent(QShowEvent* event) override;
+
 private slots:
   void on_databaseComboBox_currentIndexChanged(const QString &database);
+  void onCatalogLoadingFailed(const QString& errorMessage);
+  void onCatalogLoadingFinished();
+  void onCatalogTracksLoaded(const QVector<TrackData>& tracks);
+  void onIndexingFailed(const QString& errorMessage);
+  void onIndexingFinished(const int updatedTracks, const int removedTracks);
 
 private:
   Ui::OpenTrackDialog *ui;
   VeloDb* productionDb;
   VeloDb* betaDb;
   VeloDb* customDb;
+  TrackCatalogModel* trackCatalogModel;
+  QSortFilterProxyModel* trackCatalogProxyModel;
+  TrackCatalogLoader* catalogLoader = nullptr;
+  VeloDb* loadingDatabase = nullptr;
+  CatalogStamp loadingStamp;
+  VeloDb* shownDatabase = nullptr;
+  uint shownCatalogRevision = 0;
+  TrackIndexer* indexer = nullptr;
+  VeloDb* indexingDatabase = nullptr;
+
+  void cancelIndexing();
+  void cancelLoading();
+  VeloDb* getSelectedDatabase() const;
   void loadDatabase(VeloDb* database);
+  bool loadSummaries(VeloDb* database);
+  void startIndexing(VeloDb* database);
 };
 
 #endif // OPENTRACKDIALOG_H
@@ -0,0 +1,87 @@
+#include "prefabregistry.h"
+
+PrefabRegistry::PrefabRegistry(const QVector<PrefabData>& prefabs) :
+  prefabs(prefabs)
+{
+  indexById.reserve(prefabs.count());
+  capabilities.reserve(prefabs.count());
+  for (int i = 0; i < prefabs.count(); ++i) {
+    indexById.insert(prefabs[i].id, i);
+    capabilities.append(computeCapabilities(prefabs[i]));
+  }
+}
+
+bool PrefabRegistry::contains(const uint id) const
+{
+  return indexById.contains(id);
+}
+
+int PrefabRegistry::count() const
+{
+  return prefabs.count();
+}
+
+const PrefabData* PrefabRegistry::find(const uint id) const
+{
+  const int index = indexById.value(id, -1);
+  if (index < 0)
+    return nullptr;
+
+  return &prefabs[index];
+}
+
+const PrefabData* PrefabRegistry::find(const uint id, quint8& capabilities) const
+{
+  const int index = indexById.value(id, -1);
+  if (index < 0)
+    return nullptr;
+
+  capabilities = this->capabilities[index];
+  return &prefabs[index];
+}
+
+PrefabData PrefabRegistry::get(const uint id) const
+{
+  const PrefabData* prefab = find(id);
+  if (prefab == nullptr)
+    return PrefabData();
+
+  return *prefab;
+}
+
+const QVector<PrefabData>& PrefabRegistry::getPrefabs() const
+{
+  return prefabs;
+}
+
+quint8 PrefabRegistry::computeCapabilities(const PrefabData& prefab)
+{
+  const bool hasStartGridName = (prefab.name == "DefaultStartGrid" ||
+                                 prefab.name == "DefaultKDRAStartGrid" ||
+                                 prefab.name == "DR1StartGrid" ||
+                                 prefab.name == "PolyStartGrid" ||
+                                 prefab.name == "MicroStartGrid");
+  const bool isSplinePart = (prefab.name == "CtrlParent" ||
+                             prefab.name == "ControlCurve" ||
+                             prefab.name == "ControlPoint");
+
+  quint8 result = 0;
+
+  // Start grids and the parts of a spline can not be edited directly
+  if (!hasStartGridName && !isSplinePart)
+    result |= Editable;
+
+  if (prefab.id > 0 && hasStartGridName)
+    result |= StartGrid;
+
+  if (prefab.name == "ControlCurve")
+    result |= Spline;
+
+  if (prefab.id == 345)
+    result |= SplineControl;
+
+  if (prefab.gate)
+    result |= Gate;
+
+  return result;
+}
@@ -0,0 +1,42 @@
+#ifndef PREFABREGISTRY_H
+#define PREFABREGISTRY_H
+
+#include <QHash>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "velodb.h"
+
+class PrefabRegistry
+{
+public:
+  // What a prefab is, derived from its name and flags once when the registry is built
+  enum Capability : quint8 {
+    Editable = 0x01,
+    StartGrid = 0x02,
+    Spline = 0x04,
+    SplineControl = 0x08,
+    Gate = 0x10
+  };
+
+  explicit PrefabRegistry(const QVector<PrefabData>& prefabs = QVector<PrefabData>());
+
+  bool contains(const uint id) const;
+  int count() const;
+  const PrefabData* find(const uint id) const;
+  const PrefabData* find(const uint id, quint8& capabilities) const;
+  PrefabData get(const uint id) const;
+  const QVector<PrefabData>& getPrefabs() const;
+
+  static quint8 computeCapabilities(const PrefabData& prefab);
+
+private:
+  QVector<PrefabData> prefabs;
+  QVector<quint8> capabilities;
+  QHash<uint, int> indexById;
+};
+
+// The registry is immutable once built, so every editor of the same settings database can share it
+typedef QSharedPointer<const PrefabRegistry> PrefabRegistryPtr;
+
+#endif // PREFABREGISTRY_H
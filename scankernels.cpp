@@ -0,0 +1,240 @@
+#include "scankernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define SCANKERNELS_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#  include <immintrin.h>
+#endif
+
+// SSE2 is only used where the compiler may assume it anyway (always the case on x86-64)
+#if defined(SCANKERNELS_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define SCANKERNELS_SSE2
+#endif
+
+// AVX2 is compiled in for these functions only and picked at runtime
+#if defined(SCANKERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#  define SCANKERNELS_AVX2
+#  define SCANKERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(SCANKERNELS_X86) && defined(_MSC_VER)
+#  define SCANKERNELS_AVX2
+#  define SCANKERNELS_TARGET_AVX2
+#endif
+
+namespace {
+
+enum InstructionSet {
+  Scalar,
+  Sse2,
+  Avx2
+};
+
+bool cpuHasAvx2()
+{
+#if defined(SCANKERNELS_AVX2) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+
+  // The cpu needs AVX and the os has to save the ymm registers
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+    return false;
+  if ((_xgetbv(0) & 6) != 6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#elif defined(SCANKERNELS_AVX2)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+InstructionSet instructionSet()
+{
+  static const InstructionSet value = cpuHasAvx2() ? Avx2 :
+#ifdef SCANKERNELS_SSE2
+                                                     Sse2;
+#else
+                                                     Scalar;
+#endif
+  return value;
+}
+
+inline void combineWord(quint64& word, const quint64 bits, const ScanKernels::Combine combine)
+{
+  switch (combine) {
+  case ScanKernels::Replace: word = bits; break;
+  case ScanKernels::And: word &= bits; break;
+  case ScanKernels::Or: word |= bits; break;
+  }
+}
+
+template<ScanKernels::Compare C>
+inline bool compareValue(const int value, const int operand)
+{
+  switch (C) {
+  case ScanKernels::Equal: return value == operand;
+  case ScanKernels::Less: return value < operand;
+  case ScanKernels::Greater: return value > operand;
+  }
+  return false;
+}
+
+template<ScanKernels::Compare C>
+quint64 compareBlockScalar(const int* values, const int count, const int operand)
+{
+  quint64 bits = 0;
+  for (int i = 0; i < count; ++i)
+    bits |= quint64(compareValue<C>(values[i], operand)) << i;
+
+  return bits;
+}
+
+template<ScanKernels::Compare C>
+void compareScalar(const int* values, const int wordCount, const int operand, quint64* mask, const ScanKernels::Combine combine)
+{
+  for (int word = 0; word < wordCount; ++word)
+    combineWord(mask[word], compareBlockScalar<C>(values + word * 64, 64, operand), combine);
+}
+
+#ifdef SCANKERNELS_SSE2
+template<ScanKernels::Compare C>
+void compareSse2(const int* values, const int wordCount, const int operand, quint64* mask, const ScanKernels::Combine combine)
+{
+  const __m128i operands = _mm_set1_epi32(operand);
+
+  for (int word = 0; word < wordCount; ++word) {
+    const int* block = values + word * 64;
+    quint64 bits = 0;
+    for (int i = 0; i < 64; i += 4) {
+      const __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+      __m128i result;
+      switch (C) {
+      case ScanKernels::Equal: result = _mm_cmpeq_epi32(lane, operands); break;
+      case ScanKernels::Less: result = _mm_cmplt_epi32(lane, operands); break;
+      case ScanKernels::Greater: result = _mm_cmpgt_epi32(lane, operands); break;
+      }
+      bits |= quint64(_mm_movemask_ps(_mm_castsi128_ps(result))) << i;
+    }
+    combineWord(mask[word], bits, combine);
+  }
+}
+
+void testBitsSse2(const quint8* values, const int wordCount, const quint8 testedBits, quint64* mask, const ScanKernels::Combine combine)
+{
+  const __m128i tested = _mm_set1_epi8(char(testedBits));
+  const __m128i zero = _mm_setzero_si128();
+
+  for (int word = 0; word < wordCount; ++word) {
+    const quint8* block = values + word * 64;
+    quint64 bits = 0;
+    for (int i = 0; i < 64; i += 16) {
+      const __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+      // The movemask has the bytes without any of the bits set
+      const int unset = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lane, tested), zero));
+      bits |= quint64(~unset & 0xFFFF) << i;
+    }
+    combineWord(mask[word], bits, combine);
+  }
+}
+#endif
+
+#ifdef SCANKERNELS_AVX2
+template<ScanKernels::Compare C>
+SCANKERNELS_TARGET_AVX2 void compareAvx2(const int* values, const int wordCount, const int operand, quint64* mask, const ScanKernels::Combine combine)
+{
+  const __m256i operands = _mm256_set1_epi32(operand);
+
+  for (int word = 0; word < wordCount; ++word) {
+    const int* block = values + word * 64;
+    quint64 bits = 0;
+    for (int i = 0; i < 64; i += 8) {
+      const __m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+      __m256i result;
+      switch (C) {
+      case ScanKernels::Equal: result = _mm256_cmpeq_epi32(lane, operands); break;
+      case ScanKernels::Less: result = _mm256_cmpgt_epi32(operands, lane); break;
+      case ScanKernels::Greater: result = _mm256_cmpgt_epi32(lane, operands); break;
+      }
+      bits |= quint64(quint32(_mm256_movemask_ps(_mm256_castsi256_ps(result)))) << i;
+    }
+    combineWord(mask[word], bits, combine);
+  }
+}
+#endif
+
+template<ScanKernels::Compare C>
+void compareColumn(const int* values, const int count, const int operand, quint64* mask, const ScanKernels::Combine combine)
+{
+  const int wordCount = count / 64;
+
+  switch (instructionSet()) {
+#ifdef SCANKERNELS_AVX2
+  case Avx2: compareAvx2<C>(values, wordCount, operand, mask, combine); break;
+#endif
+#ifdef SCANKERNELS_SSE2
+  case Sse2: compareSse2<C>(values, wordCount, operand, mask, combine); break;
+#endif
+  default: compareScalar<C>(values, wordCount, operand, mask, combine); break;
+  }
+
+  // The rest of the last word
+  const int rest = count - wordCount * 64;
+  if (rest > 0)
+    combineWord(mask[wordCount], compareBlockScalar<C>(values + wordCount * 64, rest, operand), combine);
+}
+
+}
+
+void ScanKernels::compare(const int* values, const int count, const Compare compare, const int operand, quint64* mask, const Combine combine)
+{
+  switch (compare) {
+  case Equal: compareColumn<Equal>(values, count, operand, mask, combine); break;
+  case Less: compareColumn<Less>(values, count, operand, mask, combine); break;
+  case Greater: compareColumn<Greater>(values, count, operand, mask, combine); break;
+  }
+}
+
+void ScanKernels::testBits(const quint8* values, const int count, const quint8 bits, quint64* mask, const Combine combine)
+{
+#ifdef SCANKERNELS_SSE2
+  // Bytes are cheap enough that AVX2 does not buy anything here
+  const int vectorWordCount = count / 64;
+  testBitsSse2(values, vectorWordCount, bits, mask, combine);
+#else
+  const int vectorWordCount = 0;
+#endif
+
+  for (int word = vectorWordCount; word < getWordCount(count); ++word) {
+    quint64 wordBits = 0;
+    for (int i = word * 64; i < qMin(count, (word + 1) * 64); ++i)
+      wordBits |= quint64((values[i] & bits) != 0) << (i - word * 64);
+    combineWord(mask[word], wordBits, combine);
+  }
+}
+
+void ScanKernels::combineMasks(const quint64* source, const int wordCount, quint64* mask, const Combine combine)
+{
+  for (int word = 0; word < wordCount; ++word)
+    combineWord(mask[word], source[word], combine);
+}
+
+int ScanKernels::getWordCount(const int count)
+{
+  return (count + 63) / 64;
+}
+
+const char* ScanKernels::getInstructionSet()
+{
+  switch (instructionSet()) {
+  case Avx2: return "AVX2";
+  case Sse2: return "SSE2";
+  default: return "scalar";
+  }
+}
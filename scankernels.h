@@ -0,0 +1,33 @@
+#ifndef SCANKERNELS_H
+#define SCANKERNELS_H
+
+#include <QtGlobal>
+
+// Compares whole columns of the track store against a value and writes the result as a
+// bitmask, one bit per slot and 64 slots per word. Uses AVX2 or SSE2 where the cpu has it
+// and falls back to plain loops otherwise, the results are the same either way.
+class ScanKernels
+{
+public:
+  enum Compare {
+    Equal,
+    Less,
+    Greater
+  };
+
+  // How the new bits are merged into the mask
+  enum Combine {
+    Replace,
+    And,
+    Or
+  };
+
+  static void compare(const int* values, const int count, const Compare compare, const int operand, quint64* mask, const Combine combine);
+  static void testBits(const quint8* values, const int count, const quint8 bits, quint64* mask, const Combine combine);
+  static void combineMasks(const quint64* source, const int wordCount, quint64* mask, const Combine combine);
+
+  static int getWordCount(const int count);
+  static const char* getInstructionSet();
+};
+
+#endif // SCANKERNELS_H
@@ -0,0 +1,81 @@
+#include "searchfilter.h"
+
+SearchFilter::SearchFilter(const QModelIndex& customIndex) :
+  SearchFilter(FilterTypes::CustomIndex, FilterMethods::Is, 0, customIndex)
+{
+}
+
+SearchFilter::SearchFilter(const SearchQueryPtr& query) :
+  type(FilterTypes::Query),
+  query(query)
+{
+}
+
+SearchFilter::SearchFilter(const FilterTypes type, const FilterMethods method, const int value, const QModelIndex& customIndex) :
+  type(type),
+  method(method),
+  value(value)
+{
+  // Objects are always compared by their id
+  if (type == FilterTypes::Object)
+    this->method = FilterMethods::Is;
+
+  if (type == FilterTypes::CustomIndex && customIndex.isValid())
+    customIndexList.append(customIndex);
+}
+
+void SearchFilter::addCustomIndex(const QModelIndex& index)
+{
+  if (type == FilterTypes::CustomIndex && index.isValid())
+    customIndexList.append(index);
+}
+
+bool SearchFilter::containsCustomIndex(const QModelIndex& index) const
+{
+  return customIndexList.contains(index);
+}
+
+QModelIndexList SearchFilter::getCustomIndexList() const
+{
+  return customIndexList;
+}
+
+void SearchFilter::removeCustomIndex(const QModelIndex& index)
+{
+  customIndexList.removeOne(index);
+}
+
+FilterTypes SearchFilter::getType() const
+{
+  return type;
+}
+
+void SearchFilter::setType(const FilterTypes value)
+{
+  type = value;
+}
+
+FilterMethods SearchFilter::getMethod() const
+{
+  return method;
+}
+
+void SearchFilter::setMethod(const FilterMethods value)
+{
+  method = value;
+}
+
+int SearchFilter::getValue() const
+{
+  return value;
+}
+
+void SearchFilter::setValue(const int value)
+{
+  this->value = value;
+}
+
+SearchQueryPtr SearchFilter::getQuery() const
+{
+  return query;
+}
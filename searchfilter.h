@@ -0,0 +1,75 @@
+#ifndef SEARCHFILTER_H
+#define SEARCHFILTER_H
+
+#include <QModelIndex>
+#include <QModelIndexList>
+#include <QSharedPointer>
+
+enum FilterTypes {
+  Object      = 0,
+  AnyPosition = 1,
+  PositionR   = 2,
+  PositionG   = 3,
+  PositionB   = 4,
+  AnyRotation = 5,
+  RotationW   = 6,
+  RotationX   = 7,
+  RotationY   = 8,
+  RotationZ   = 9,
+  AnyScaling  = 10,
+  ScalingR    = 11,
+  ScalingG    = 12,
+  ScalingB    = 13,
+  GateNo      = 14,
+  IsDublicate = 15,
+  IsOnSpline  = 16,
+  Query       = 17,
+  CustomIndex = 255
+};
+
+enum FilterMethods {
+  Contains = 0,
+  Is = 1,
+  SmallerThan = 2,
+  BiggerThan = 3,
+};
+
+class SearchQuery;
+typedef QSharedPointer<const SearchQuery> SearchQueryPtr;
+
+// Describes one filter of a search. This is what NodeEditor::search works with, the
+// NodeFilter widget only shows one of these, so searches can be run without any widgets.
+class SearchFilter
+{
+public:
+  SearchFilter() = default;
+  explicit SearchFilter(const QModelIndex& customIndex);
+  explicit SearchFilter(const SearchQueryPtr& query);
+  SearchFilter(const FilterTypes type, const FilterMethods method, const int value, const QModelIndex& customIndex = QModelIndex());
+
+  void addCustomIndex(const QModelIndex& index);
+  bool containsCustomIndex(const QModelIndex& index) const;
+  QModelIndexList getCustomIndexList() const;
+  void removeCustomIndex(const QModelIndex& index);
+
+  FilterTypes getType() const;
+  void setType(const FilterTypes value);
+
+  FilterMethods getMethod() const;
+  void setMethod(const FilterMethods value);
+
+  int getValue() const;
+  void setValue(const int value);
+
+  // The parsed query of a Query filter, all of it has to match like any other filter
+  SearchQueryPtr getQuery() const;
+
+private:
+  FilterTypes type = FilterTypes::Object;
+  FilterMethods method = FilterMethods::Is;
+  int value = 0;
+  QModelIndexList customIndexList;
+  SearchQueryPtr query;
+};
+
+#endif // SEARCHFILTER_H
@@ -54,6 +54,24 @@ void SearchFilterLayout::addFilter(const FilterTypes filterType, const FilterMet
   doLayout(maxWidth);
 }
 
+void SearchFilterLayout::addFilter(const SearchQueryPtr& query)
+{
+  if (query.isNull() || query->isEmpty())
+    return;
+
+  // The same query twice would not change anything
+  foreach(NodeFilter* setFilter, filterList) {
+    if (setFilter->getFilterType() == FilterTypes::Query && setFilter->getFilterDisplayValue() == query->getText())
+      return;
+  }
+
+  NodeFilter* filter = new NodeFilter(SearchFilter(query), query->getText());
+  filterList.append(filter);
+  connect(filter, SIGNAL(removeReleased(NodeFilter*)), this, SLOT(removeFilter_released(NodeFilter*)));
+
+  doLayout(maxWidth);
+}
+
 void SearchFilterLayout::clear()
 {
   // Remove and delete all filter and rows
@@ -75,6 +93,16 @@ QVector<NodeFilter *> SearchFilterLayout::getFilterList() const
   return filterList;
 }
 
+QVector<SearchFilter> SearchFilterLayout::getFilters() const
+{
+  QVector<SearchFilter> filters;
+  filters.reserve(filterList.count());
+  foreach(NodeFilter* filter, filterList)
+    filters.append(filter->getFilter());
+
+  return filters;
+}
+
 void SearchFilterLayout::removeCustomIndex(const QModelIndex &customIndex)
 {
   foreach(NodeFilter* setFilter, filterList) {
@@ -12,6 +12,7 @@
 #include <QWidget>
 
 #include "nodefilter.h"
+#include "searchquery.h"
 
 class SearchFilterLayout : public QVBoxLayout
 {
@@ -22,10 +23,12 @@ public:
 
   void addFilter(const QModelIndex& index);
   void addFilter(const FilterTypes filterType, const FilterMethods filterMethod, int value, const QString displayValue = "", const QModelIndex &customIndex = QModelIndex());
+  void addFilter(const SearchQueryPtr& query);
 
   void clear();
 
   QVector<NodeFilter *> getFilterList() const;
+  QVector<SearchFilter> getFilters() const;
 
   void removeCustomIndex(const QModelIndex& customIndex);
 
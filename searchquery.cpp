@@ -0,0 +1,430 @@
+#include "searchquery.h"
+
+#include <limits>
+
+#include "exceptions.h"
+
+class SearchQuery::Parser
+{
+public:
+  Parser(SearchQuery& query, const QVector<PrefabData>& prefabs);
+
+  int parse(const QString& text);
+
+private:
+  enum TokenType {
+    End,
+    Word,
+    Number,
+    Text,
+    Operator,
+    OpenBracket,
+    CloseBracket
+  };
+
+  struct Token
+  {
+    TokenType type;
+    QString text;
+    int position;
+  };
+
+  SearchQuery& query;
+  const QVector<PrefabData>& prefabs;
+  QVector<Token> tokens;
+  int current = 0;
+
+  void tokenize(const QString& text);
+
+  const Token& peek() const;
+  Token take();
+  bool takeKeyword(const QString& keyword, const QString& symbol);
+
+  int parseOr();
+  int parseAnd();
+  int parseUnary();
+  int parseTerm();
+  int parseComparison(const FilterTypes type, const Token& op, const Token& value);
+  int parsePrefab(const Token& op, const Token& value);
+
+  int toNumber(const Token& token) const;
+  static bool findField(const QString& name, FilterTypes& type);
+};
+
+SearchQuery::Parser::Parser(SearchQuery& query, const QVector<PrefabData>& prefabs) :
+  query(query),
+  prefabs(prefabs)
+{
+}
+
+int SearchQuery::Parser::parse(const QString& text)
+{
+  tokenize(text);
+  if (peek().type == End)
+    return -1;
+
+  const int root = parseOr();
+  if (peek().type != End)
+    throw InvalidSearchQueryException(QString("Unexpected '%1'").arg(peek().text), peek().position);
+
+  return root;
+}
+
+void SearchQuery::Parser::tokenize(const QString& text)
+{
+  int i = 0;
+  while (i < text.length()) {
+    const QChar c = text.at(i);
+    const int start = i;
+
+    if (c.isSpace()) {
+      i++;
+      continue;
+    }
+
+    if (c == '(' || c == ')') {
+      tokens.append({ c == '(' ? OpenBracket : CloseBracket, QString(c), start });
+      i++;
+      continue;
+    }
+
+    if (c.isDigit() || (c == '-' && i + 1 < text.length() && text.at(i + 1).isDigit())) {
+      i++;
+      while (i < text.length() && text.at(i).isDigit())
+        i++;
+      tokens.append({ Number, text.mid(start, i - start), start });
+      continue;
+    }
+
+    if (c.isLetter() || c == '_') {
+      while (i < text.length() && (text.at(i).isLetterOrNumber() || text.at(i) == '_' || text.at(i) == '.'))
+        i++;
+      tokens.append({ Word, text.mid(start, i - start), start });
+      continue;
+    }
+
+    if (c == '"' || c == '\'') {
+      const int end = text.indexOf(c, i + 1);
+      if (end < 0)
+        throw InvalidSearchQueryException("Missing closing quote", start);
+      tokens.append({ Text, text.mid(start + 1, end - start - 1), start });
+      i = end + 1;
+      continue;
+    }
+
+    // Two character operators first, so "<=" does not end up as "<" and "="
+    const QString pair = text.mid(i, 2);
+    if (pair == "==" || pair == "!=" || pair == "<=" || pair == ">=" || pair == "&&" || pair == "||") {
+      tokens.append({ Operator, pair, start });
+      i += 2;
+      continue;
+    }
+
+    if (c == '=' || c == '<' || c == '>' || c == '~' || c == '!') {
+      tokens.append({ Operator, QString(c), start });
+      i++;
+      continue;
+    }
+
+    throw InvalidSearchQueryException(QString("Unexpected character '%1'").arg(c), start);
+  }
+
+  tokens.append({ End, "end of query", text.length() });
+}
+
+const SearchQuery::Parser::Token& SearchQuery::Parser::peek() const
+{
+  return tokens.at(current);
+}
+
+SearchQuery::Parser::Token SearchQuery::Parser::take()
+{
+  const Token token = tokens.at(current);
+  if (token.type != End)
+    current++;
+
+  return token;
+}
+
+bool SearchQuery::Parser::takeKeyword(const QString& keyword, const QString& symbol)
+{
+  const Token& token = peek();
+  if ((token.type == Word && token.text.compare(keyword, Qt::CaseInsensitive) == 0) ||
+      (token.type == Operator && token.text == symbol)) {
+    take();
+    return true;
+  }
+
+  return false;
+}
+
+int SearchQuery::Parser::parseOr()
+{
+  QVector<int> children;
+  children.append(parseAnd());
+  while (takeKeyword("or", "||"))
+    children.append(parseAnd());
+
+  return children.count() == 1 ? children.first() : query.addNode(SearchQuery::Or, children);
+}
+
+int SearchQuery::Parser::parseAnd()
+{
+  QVector<int> children;
+  children.append(parseUnary());
+  while (takeKeyword("and", "&&"))
+    children.append(parseUnary());
+
+  return children.count() == 1 ? children.first() : query.addNode(SearchQuery::And, children);
+}
+
+int SearchQuery::Parser::parseUnary()
+{
+  if (takeKeyword("not", "!"))
+    return query.addNode(SearchQuery::Not, QVector<int>() << parseUnary());
+
+  if (peek().type == OpenBracket) {
+    take();
+    const int node = parseOr();
+    if (peek().type != CloseBracket)
+      throw InvalidSearchQueryException(QString("Expected ')' instead of '%1'").arg(peek().text), peek().position);
+    take();
+    return node;
+  }
+
+  return parseTerm();
+}
+
+int SearchQuery::Parser::parseTerm()
+{
+  const Token field = take();
+  if (field.type != Word)
+    throw InvalidSearchQueryException(QString("Expected a field instead of '%1'").arg(field.text), field.position);
+
+  const QString name = field.text.toLower();
+
+  if (name == "onspline")
+    return query.addFilter(SearchFilter(FilterTypes::IsOnSpline, FilterMethods::Is, 0));
+
+  if (name == "duplicate") {
+    // duplicate(5) also finds objects that are up to 5 apart
+    int tolerance = 0;
+    if (peek().type == OpenBracket) {
+      take();
+      const Token value = take();
+      if (value.type != Number)
+        throw InvalidSearchQueryException(QString("Expected a tolerance instead of '%1'").arg(value.text), value.position);
+      tolerance = toNumber(value);
+      if (tolerance < 0)
+        throw InvalidSearchQueryException("The tolerance can not be negative", value.position);
+      if (peek().type != CloseBracket)
+        throw InvalidSearchQueryException(QString("Expected ')' instead of '%1'").arg(peek().text), peek().position);
+      take();
+    }
+    return query.addFilter(SearchFilter(FilterTypes::IsDublicate, FilterMethods::Is, tolerance));
+  }
+
+  FilterTypes type;
+  if (!findField(name, type))
+    throw InvalidSearchQueryException(QString("Unknown field '%1'").arg(field.text), field.position);
+
+  const Token op = take();
+  if (op.type != Operator || op.text == "!" || op.text == "&&" || op.text == "||")
+    throw InvalidSearchQueryException(QString("Expected a comparison after '%1'").arg(field.text), op.position);
+
+  const Token value = take();
+  if (value.type != Number && value.type != Word && value.type != Text)
+    throw InvalidSearchQueryException(QString("Expected a value instead of '%1'").arg(value.text), value.position);
+
+  if (type == FilterTypes::Object)
+    return parsePrefab(op, value);
+
+  return parseComparison(type, op, value);
+}
+
+int SearchQuery::Parser::parseComparison(const FilterTypes type, const Token& op, const Token& value)
+{
+  if (value.type != Number)
+    throw InvalidSearchQueryException(QString("Expected a number instead of '%1'").arg(value.text), value.position);
+
+  const int number = toNumber(value);
+
+  if (op.text == "=" || op.text == "==")
+    return query.addFilter(SearchFilter(type, FilterMethods::Is, number));
+  if (op.text == "~")
+    return query.addFilter(SearchFilter(type, FilterMethods::Contains, number));
+  if (op.text == "<")
+    return query.addFilter(SearchFilter(type, FilterMethods::SmallerThan, number));
+  if (op.text == ">")
+    return query.addFilter(SearchFilter(type, FilterMethods::BiggerThan, number));
+  if (op.text == "!=")
+    return query.addNode(SearchQuery::Not, QVector<int>() << query.addFilter(SearchFilter(type, FilterMethods::Is, number)));
+
+  // The values are whole numbers, so <= and >= are < and > of the next number.
+  // That keeps the any-axis fields meaning "any axis is <= x", which a negated > would not.
+  if (op.text == "<=") {
+    if (number == std::numeric_limits<int>::max())
+      return query.addNode(SearchQuery::Not, QVector<int>() << query.addFilter(SearchFilter(type, FilterMethods::BiggerThan, number)));
+    return query.addFilter(SearchFilter(type, FilterMethods::SmallerThan, number + 1));
+  }
+
+  if (number == std::numeric_limits<int>::min())
+    return query.addNode(SearchQuery::Not, QVector<int>() << query.addFilter(SearchFilter(type, FilterMethods::SmallerThan, number)));
+  return query.addFilter(SearchFilter(type, FilterMethods::BiggerThan, number - 1));
+}
+
+int SearchQuery::Parser::parsePrefab(const Token& op, const Token& value)
+{
+  const bool isEqual = (op.text == "=" || op.text == "==");
+  const bool isNotEqual = (op.text == "!=");
+  const bool isContains = (op.text == "~");
+
+  if (!isEqual && !isNotEqual && !(isContains && value.type != Number))
+    throw InvalidSearchQueryException(QString("Prefabs can not be compared with '%1'").arg(op.text), op.position);
+
+  QVector<int> children;
+  if (value.type == Number) {
+    children.append(query.addFilter(SearchFilter(FilterTypes::Object, FilterMethods::Is, toNumber(value))));
+  } else {
+    // Names are not unique, so every prefab with a matching name is looked for
+    foreach(const PrefabData& prefab, prefabs) {
+      const bool matches = isContains ?
+                           prefab.name.contains(value.text, Qt::CaseInsensitive) :
+                           prefab.name.compare(value.text, Qt::CaseInsensitive) == 0;
+      if (matches)
+        children.append(query.addFilter(SearchFilter(FilterTypes::Object, FilterMethods::Is, int(prefab.id))));
+    }
+
+    if (children.isEmpty())
+      throw InvalidSearchQueryException(QString("Unknown prefab '%1'").arg(value.text), value.position);
+  }
+
+  const int node = children.count() == 1 ? children.first() : query.addNode(SearchQuery::Or, children);
+  if (isNotEqual)
+    return query.addNode(SearchQuery::Not, QVector<int>() << node);
+
+  return node;
+}
+
+int SearchQuery::Parser::toNumber(const Token& token) const
+{
+  bool ok = false;
+  const int number = token.text.toInt(&ok);
+  if (!ok)
+    throw InvalidSearchQueryException(QString("The number %1 is too big").arg(token.text), token.position);
+
+  return number;
+}
+
+bool SearchQuery::Parser::findField(const QString& name, FilterTypes& type)
+{
+  const int dot = name.indexOf('.');
+  const QString base = dot < 0 ? name : name.left(dot);
+  const QString axis = dot < 0 ? QString() : name.mid(dot + 1);
+
+  if (base == "prefab" || base == "object") {
+    type = FilterTypes::Object;
+    return axis.isEmpty();
+  }
+
+  if (base == "gate") {
+    type = FilterTypes::GateNo;
+    return axis.isEmpty();
+  }
+
+  if (base == "pos" || base == "position" || base == "scale" || base == "scaling") {
+    const bool position = (base == "pos" || base == "position");
+    if (axis.isEmpty())
+      type = position ? FilterTypes::AnyPosition : FilterTypes::AnyScaling;
+    else if (axis == "r" || axis == "x")
+      type = position ? FilterTypes::PositionR : FilterTypes::ScalingR;
+    else if (axis == "g" || axis == "y")
+      type = position ? FilterTypes::PositionG : FilterTypes::ScalingG;
+    else if (axis == "b" || axis == "z")
+      type = position ? FilterTypes::PositionB : FilterTypes::ScalingB;
+    else
+      return false;
+    return true;
+  }
+
+  if (base == "rot" || base == "rotation") {
+    if (axis.isEmpty())
+      type = FilterTypes::AnyRotation;
+    else if (axis == "w")
+      type = FilterTypes::RotationW;
+    else if (axis == "x")
+      type = FilterTypes::RotationX;
+    else if (axis == "y")
+      type = FilterTypes::RotationY;
+    else if (axis == "z")
+      type = FilterTypes::RotationZ;
+    else
+      return false;
+    return true;
+  }
+
+  return false;
+}
+
+SearchQuery::SearchQuery(const QVector<SearchFilter>& filterList)
+{
+  QVector<int> children;
+  foreach(const SearchFilter& filter, filterList)
+    children.append(addFilter(filter));
+
+  if (children.count() == 1)
+    root = children.first();
+  else if (children.count() > 1)
+    root = addNode(And, children);
+}
+
+SearchQuery SearchQuery::parse(const QString& text, const QVector<PrefabData>& prefabs)
+{
+  SearchQuery query;
+  query.text = text.trimmed();
+
+  Parser parser(query, prefabs);
+  query.root = parser.parse(query.text);
+
+  return query;
+}
+
+bool SearchQuery::isEmpty() const
+{
+  return root < 0;
+}
+
+int SearchQuery::getRoot() const
+{
+  return root;
+}
+
+const SearchQuery::Node& SearchQuery::getNode(const int index) const
+{
+  return nodes.at(index);
+}
+
+QString SearchQuery::getText() const
+{
+  return text;
+}
+
+int SearchQuery::addFilter(const SearchFilter& filter)
+{
+  Node node;
+  node.type = Filter;
+  node.filter = filter;
+  nodes.append(node);
+
+  return nodes.count() - 1;
+}
+
+int SearchQuery::addNode(const NodeType type, const QVector<int>& children)
+{
+  Node node;
+  node.type = type;
+  node.children = children;
+  nodes.append(node);
+
+  return nodes.count() - 1;
+}
@@ -0,0 +1,59 @@
+#ifndef SEARCHQUERY_H
+#define SEARCHQUERY_H
+
+#include <QString>
+#include <QVector>
+
+#include "searchfilter.h"
+#include "velodb.h"
+
+// A boolean combination of search filters, written as text like
+//   prefab=Pylon AND (pos.y>500 OR gate<3) AND NOT onSpline
+// The query only describes what has to match, FilterPlan decides in which order it gets checked.
+//
+// Fields: prefab (id or name), pos/rot/scale with an optional axis (pos.x or pos.r, rot.w, ...),
+// gate, and the flags onSpline and duplicate(tolerance).
+// Operators: = != < > <= >= and ~ (contains), combined with AND/&&, OR/||, NOT/! and brackets.
+// Without an axis a comparison matches if any axis does, like the Any* filters.
+class SearchQuery
+{
+public:
+  enum NodeType {
+    Filter,
+    And,
+    Or,
+    Not
+  };
+
+  struct Node
+  {
+    NodeType type;
+    SearchFilter filter;
+    QVector<int> children;
+  };
+
+  SearchQuery() = default;
+
+  // All filters of the list have to match
+  explicit SearchQuery(const QVector<SearchFilter>& filterList);
+
+  // Prefab names are resolved against the given prefabs, throws InvalidSearchQueryException
+  static SearchQuery parse(const QString& text, const QVector<PrefabData>& prefabs = QVector<PrefabData>());
+
+  bool isEmpty() const;
+  int getRoot() const;
+  const Node& getNode(const int index) const;
+  QString getText() const;
+
+private:
+  class Parser;
+
+  QVector<Node> nodes;
+  int root = -1;
+  QString text;
+
+  int addFilter(const SearchFilter& filter);
+  int addNode(const NodeType type, const QVector<int>& children);
+};
+
+#endif // SEARCHQUERY_H
@@ -0,0 +1,252 @@
+#include "spatialindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "editorobject.h"
+
+const quint64 SpatialIndex::noCell;
+
+SpatialIndex::SpatialIndex(TrackStore& store, const int cellSize) :
+  store(store),
+  cellSize(qMax(1, cellSize))
+{
+}
+
+QVector<EditorObject*> SpatialIndex::findInBox(const QVector3D& min, const QVector3D& max)
+{
+  update();
+
+  QVector<EditorObject*> result;
+  foreach(const int slot, collectCandidates(cellOf(min), cellOf(max))) {
+    const float x = store.getValue(TrackStore::PositionR, slot);
+    const float y = store.getValue(TrackStore::PositionG, slot);
+    const float z = store.getValue(TrackStore::PositionB, slot);
+    if (x >= min.x() && x <= max.x() &&
+        y >= min.y() && y <= max.y() &&
+        z >= min.z() && z <= max.z())
+      result.append(store.getObject(slot));
+  }
+
+  return result;
+}
+
+QVector<EditorObject*> SpatialIndex::findInRadius(const QVector3D& center, const float radius)
+{
+  update();
+
+  const QVector3D extent(radius, radius, radius);
+  const double radiusSquared = double(radius) * double(radius);
+
+  QVector<EditorObject*> result;
+  foreach(const int slot, collectCandidates(cellOf(center - extent), cellOf(center + extent))) {
+    if (distanceSquared(slot, center) <= radiusSquared)
+      result.append(store.getObject(slot));
+  }
+
+  return result;
+}
+
+QVector<EditorObject*> SpatialIndex::findNearest(const QVector3D& point, const int count)
+{
+  update();
+
+  QVector<EditorObject*> result;
+  if (count <= 0 || cells.isEmpty())
+    return result;
+
+  // The best matches so far, sorted by their distance
+  QVector<QPair<double, int>> best;
+  best.reserve(count + 1);
+
+  // Walk the grid in growing shells of cells around the point
+  const Cell center = cellOf(point);
+  const int maxRing = qMax(qMax(qMax(center.x - minCell.x, maxCell.x - center.x),
+                                qMax(center.y - minCell.y, maxCell.y - center.y)),
+                           qMax(center.z - minCell.z, maxCell.z - center.z));
+  for (int ring = 0; ring <= maxRing; ++ring) {
+    // Nothing in this shell can be closer than the shell before it, so we are done once it is out of reach
+    if (best.count() == count && ring > 0) {
+      const double reach = double(ring - 1) * cellSize;
+      if (reach * reach > best.last().first)
+        break;
+    }
+
+    for (int x = qMax(center.x - ring, minCell.x); x <= qMin(center.x + ring, maxCell.x); ++x) {
+      for (int y = qMax(center.y - ring, minCell.y); y <= qMin(center.y + ring, maxCell.y); ++y) {
+        // Inside the shell only the front and back cells are new
+        const bool onShell = (qAbs(x - center.x) == ring) || (qAbs(y - center.y) == ring);
+        const int zStep = (onShell || ring == 0) ? 1 : 2 * ring;
+        for (int z = center.z - ring; z <= center.z + ring; z += zStep) {
+          if (z < minCell.z || z > maxCell.z)
+            continue;
+
+          const QHash<quint64, QVector<int>>::const_iterator cell = cells.constFind(keyOf({ x, y, z }));
+          if (cell == cells.constEnd())
+            continue;
+
+          foreach(const int slot, cell.value()) {
+            const double distance = distanceSquared(slot, point);
+            if (best.count() == count && distance >= best.last().first)
+              continue;
+
+            QVector<QPair<double, int>>::iterator position = std::upper_bound(best.begin(), best.end(), qMakePair(distance, slot));
+            best.insert(position, qMakePair(distance, slot));
+            if (best.count() > count)
+              best.removeLast();
+          }
+        }
+      }
+    }
+  }
+
+  result.reserve(best.count());
+  for (int i = 0; i < best.count(); ++i)
+    result.append(store.getObject(best[i].second));
+
+  return result;
+}
+
+int SpatialIndex::getCellSize() const
+{
+  return cellSize;
+}
+
+void SpatialIndex::setCellSize(const int value)
+{
+  if (value == cellSize || value < 1)
+    return;
+
+  cellSize = value;
+  built = false;
+}
+
+void SpatialIndex::update()
+{
+  if (!built) {
+    rebuild();
+    return;
+  }
+
+  foreach(const int slot, store.takeMovedSlots()) {
+    removeSlot(slot);
+    if (store.isLive(slot))
+      insertSlot(slot);
+  }
+}
+
+void SpatialIndex::rebuild()
+{
+  // Everything gets inserted from scratch, so the pending moves are of no interest
+  store.takeMovedSlots();
+
+  cells.clear();
+  cellKeyBySlot.fill(noCell, store.getSlotCount());
+
+  for (int slot = 0; slot < store.getSlotCount(); ++slot) {
+    if (store.isLive(slot))
+      insertSlot(slot);
+  }
+
+  built = true;
+}
+
+void SpatialIndex::insertSlot(const int slot)
+{
+  while (cellKeyBySlot.count() <= slot)
+    cellKeyBySlot.append(noCell);
+
+  const Cell cell = cellOf(store.getValue(TrackStore::PositionR, slot),
+                           store.getValue(TrackStore::PositionG, slot),
+                           store.getValue(TrackStore::PositionB, slot));
+
+  if (cells.isEmpty()) {
+    minCell = cell;
+    maxCell = cell;
+  } else {
+    minCell = { qMin(minCell.x, cell.x), qMin(minCell.y, cell.y), qMin(minCell.z, cell.z) };
+    maxCell = { qMax(maxCell.x, cell.x), qMax(maxCell.y, cell.y), qMax(maxCell.z, cell.z) };
+  }
+
+  const quint64 key = keyOf(cell);
+  cells[key].append(slot);
+  cellKeyBySlot[slot] = key;
+}
+
+void SpatialIndex::removeSlot(const int slot)
+{
+  if (slot >= cellKeyBySlot.count() || cellKeyBySlot.at(slot) == noCell)
+    return;
+
+  const QHash<quint64, QVector<int>>::iterator cell = cells.find(cellKeyBySlot.at(slot));
+  if (cell != cells.end()) {
+    cell.value().removeOne(slot);
+    if (cell.value().isEmpty())
+      cells.erase(cell);
+  }
+
+  cellKeyBySlot[slot] = noCell;
+}
+
+QVector<int> SpatialIndex::collectCandidates(const Cell& from, const Cell& to) const
+{
+  QVector<int> candidates;
+
+  // Only look at the part of the range that contains anything at all
+  const Cell first = { qMax(from.x, minCell.x), qMax(from.y, minCell.y), qMax(from.z, minCell.z) };
+  const Cell last = { qMin(to.x, maxCell.x), qMin(to.y, maxCell.y), qMin(to.z, maxCell.z) };
+  if (cells.isEmpty() || first.x > last.x || first.y > last.y || first.z > last.z)
+    return candidates;
+
+  // A range with more cells than the grid is quicker to answer by looking at every filled cell
+  const qint64 rangeCells = qint64(last.x - first.x + 1) * qint64(last.y - first.y + 1) * qint64(last.z - first.z + 1);
+  if (rangeCells > cells.count()) {
+    for (QHash<quint64, QVector<int>>::const_iterator cell = cells.constBegin(); cell != cells.constEnd(); ++cell)
+      candidates += cell.value();
+
+    return candidates;
+  }
+
+  for (int x = first.x; x <= last.x; ++x) {
+    for (int y = first.y; y <= last.y; ++y) {
+      for (int z = first.z; z <= last.z; ++z) {
+        const QHash<quint64, QVector<int>>::const_iterator cell = cells.constFind(keyOf({ x, y, z }));
+        if (cell != cells.constEnd())
+          candidates += cell.value();
+      }
+    }
+  }
+
+  return candidates;
+}
+
+SpatialIndex::Cell SpatialIndex::cellOf(const int x, const int y, const int z) const
+{
+  return { int(std::floor(double(x) / cellSize)),
+           int(std::floor(double(y) / cellSize)),
+           int(std::floor(double(z) / cellSize)) };
+}
+
+SpatialIndex::Cell SpatialIndex::cellOf(const QVector3D& position) const
+{
+  return { int(std::floor(double(position.x()) / cellSize)),
+           int(std::floor(double(position.y()) / cellSize)),
+           int(std::floor(double(position.z()) / cellSize)) };
+}
+
+quint64 SpatialIndex::keyOf(const Cell& cell)
+{
+  // 21 bits per axis are plenty for any track, the offset keeps negative cells positive
+  return ((quint64(cell.x + 0x100000) & 0x1FFFFF) << 42) |
+         ((quint64(cell.y + 0x100000) & 0x1FFFFF) << 21) |
+          (quint64(cell.z + 0x100000) & 0x1FFFFF);
+}
+
+double SpatialIndex::distanceSquared(const int slot, const QVector3D& point) const
+{
+  const double dx = store.getValue(TrackStore::PositionR, slot) - double(point.x());
+  const double dy = store.getValue(TrackStore::PositionG, slot) - double(point.y());
+  const double dz = store.getValue(TrackStore::PositionB, slot) - double(point.z());
+
+  return dx * dx + dy * dy + dz * dz;
+}
@@ -0,0 +1,63 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <QHash>
+#include <QVector>
+#include <QVector3D>
+
+#include "trackstore.h"
+
+class EditorObject;
+
+// A uniform grid over the object positions of a track store. Objects that moved since the
+// last query are picked up from the store before every query, so the grid never has to be
+// rebuilt after the initial pass.
+class SpatialIndex
+{
+public:
+  explicit SpatialIndex(TrackStore& store, const int cellSize = 1000);
+
+  QVector<EditorObject*> findInBox(const QVector3D& min, const QVector3D& max);
+  QVector<EditorObject*> findInRadius(const QVector3D& center, const float radius);
+  QVector<EditorObject*> findNearest(const QVector3D& point, const int count);
+
+  int getCellSize() const;
+  void setCellSize(const int value);
+
+  void update();
+
+private:
+  struct Cell
+  {
+    int x;
+    int y;
+    int z;
+  };
+
+  TrackStore& store;
+  int cellSize;
+  bool built = false;
+
+  QHash<quint64, QVector<int>> cells;
+
+  // The key of the cell every slot was put into, or noCell
+  QVector<quint64> cellKeyBySlot;
+  static const quint64 noCell = ~quint64(0);
+
+  // The range of cells that contain anything, nearest neighbour searches never leave it
+  Cell minCell = { 0, 0, 0 };
+  Cell maxCell = { 0, 0, 0 };
+
+  void rebuild();
+  void insertSlot(const int slot);
+  void removeSlot(const int slot);
+  QVector<int> collectCandidates(const Cell& from, const Cell& to) const;
+
+  Cell cellOf(const int x, const int y, const int z) const;
+  Cell cellOf(const QVector3D& position) const;
+  static quint64 keyOf(const Cell& cell);
+
+  double distanceSquared(const int slot, const QVector3D& point) const;
+};
+
+#endif // SPATIALINDEX_H
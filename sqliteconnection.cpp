@@ -0,0 +1,251 @@
+#include "sqliteconnection.h"
+
+SqliteConnection::~SqliteConnection()
+{
+  close();
+}
+
+void SqliteConnection::open(const QString& filename, const bool readOnly)
+{
+  if (filename == "")
+    throw NoDatabasesFileNameException();
+
+  // Reuse the connection if it already points to the requested file
+  if (db != nullptr && this->filename == filename && this->readOnly == readOnly)
+    return;
+
+  close();
+
+  const int flags = readOnly ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+  const int resultCode = sqlite3_open_v2(filename.toUtf8().constData(), &db, flags, nullptr);
+
+  if (resultCode != SQLITE_OK) {
+    const QString errorMessage = db != nullptr ? QString(sqlite3_errmsg(db)) : QString();
+    sqlite3_close(db);
+    db = nullptr;
+    throw SQLErrorException(resultCode, errorMessage);
+  }
+
+  // Velocidrone might have the file open at the same time, so wait a bit for its locks
+  sqlite3_busy_timeout(db, 2000);
+
+  this->filename = filename;
+  this->readOnly = readOnly;
+}
+
+void SqliteConnection::close()
+{
+  // All statements have to be finalized, otherwise the connection can not be closed
+  foreach(sqlite3_stmt* statement, statements) {
+    sqlite3_finalize(statement);
+  }
+  statements.clear();
+
+  if (db != nullptr)
+    sqlite3_close(db);
+
+  db = nullptr;
+  filename = "";
+}
+
+bool SqliteConnection::isOpen() const
+{
+  return db != nullptr;
+}
+
+QString SqliteConnection::getFilename() const
+{
+  return filename;
+}
+
+sqlite3* SqliteConnection::handle() const
+{
+  return db;
+}
+
+void SqliteConnection::execute(const char* sql)
+{
+  if (db == nullptr)
+    throw NoDatabasesFileNameException();
+
+  char* zErrMsg = nullptr;
+  const int resultCode = sqlite3_exec(db, sql, nullptr, nullptr, &zErrMsg);
+
+  if (resultCode != SQLITE_OK) {
+    const QString errorMessage(zErrMsg);
+    sqlite3_free(zErrMsg);
+    throw SQLErrorException(resultCode, errorMessage);
+  }
+}
+
+sqlite3_stmt* SqliteConnection::prepare(const char* sql)
+{
+  if (db == nullptr)
+    throw NoDatabasesFileNameException();
+
+  const QByteArray key(sql);
+  sqlite3_stmt* statement = statements.value(key, nullptr);
+  if (statement != nullptr)
+    return statement;
+
+  const int resultCode = sqlite3_prepare_v2(db, sql, -1, &statement, nullptr);
+  if (resultCode != SQLITE_OK)
+    throw SQLErrorException(resultCode, sqlite3_errmsg(db));
+
+  statements.insert(key, statement);
+
+  return statement;
+}
+
+uint SqliteConnection::lastInsertRowId() const
+{
+  if (db == nullptr)
+    return 0;
+
+  return uint(sqlite3_last_insert_rowid(db));
+}
+
+SqliteStatement::SqliteStatement(SqliteConnection& connection, const char* sql) :
+  connection(connection),
+  statement(connection.prepare(sql))
+{
+}
+
+SqliteStatement::~SqliteStatement()
+{
+  // Hand the statement back to the cache in a clean state and release any read locks
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+}
+
+void SqliteStatement::bind(const int parameter, const int value)
+{
+  checkBindResult(sqlite3_bind_int(statement, parameter, value));
+}
+
+void SqliteStatement::bind(const int parameter, const uint value)
+{
+  checkBindResult(sqlite3_bind_int64(statement, parameter, sqlite3_int64(value)));
+}
+
+void SqliteStatement::bind(const int parameter, const qint64 value)
+{
+  checkBindResult(sqlite3_bind_int64(statement, parameter, sqlite3_int64(value)));
+}
+
+void SqliteStatement::bind(const int parameter, const QString& value)
+{
+  boundText.append(value.toUtf8());
+  const QByteArray& text = boundText.last();
+  checkBindResult(sqlite3_bind_text(statement, parameter, text.constData(), text.size(), SQLITE_STATIC));
+}
+
+void SqliteStatement::bind(const int parameter, const QByteArray& value)
+{
+  // The track json is stored as text, so we bind it as such without copying it
+  checkBindResult(sqlite3_bind_text(statement, parameter, value.constData(), value.size(), SQLITE_STATIC));
+}
+
+bool SqliteStatement::step()
+{
+  const int resultCode = sqlite3_step(statement);
+
+  if (resultCode == SQLITE_ROW)
+    return true;
+
+  if (resultCode == SQLITE_DONE)
+    return false;
+
+  throw SQLErrorException(resultCode, sqlite3_errmsg(connection.handle()));
+}
+
+void SqliteStatement::reset()
+{
+  // Lets the same statement be stepped again with new bindings, e.g. for every row of an insert
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+  boundText.clear();
+}
+
+int SqliteStatement::columnIndex(const char* name) const
+{
+  // Resolve the column once per statement, so rows can be read by index afterwards
+  const int columnCount = sqlite3_column_count(statement);
+  for (int i = 0; i < columnCount; ++i) {
+    if (sqlite3_stricmp(sqlite3_column_name(statement, i), name) == 0)
+      return i;
+  }
+
+  return -1;
+}
+
+bool SqliteStatement::isNull(const int column) const
+{
+  return (column < 0) || (sqlite3_column_type(statement, column) == SQLITE_NULL);
+}
+
+bool SqliteStatement::readBool(const int column) const
+{
+  if (isNull(column))
+    return false;
+
+  // Booleans are stored as integers or as "true"/"false" text, depending on who wrote them
+  if (sqlite3_column_type(statement, column) == SQLITE_INTEGER)
+    return sqlite3_column_int(statement, column) != 0;
+
+  const char* text = reinterpret_cast<const char*>(sqlite3_column_text(statement, column));
+  return (text != nullptr) && ((qstrcmp(text, "true") == 0) || (qstrcmp(text, "1") == 0));
+}
+
+int SqliteStatement::readInt(const int column) const
+{
+  if (column < 0)
+    return 0;
+
+  return sqlite3_column_int(statement, column);
+}
+
+uint SqliteStatement::readUInt(const int column) const
+{
+  if (column < 0)
+    return 0;
+
+  return uint(sqlite3_column_int64(statement, column));
+}
+
+qint64 SqliteStatement::readInt64(const int column) const
+{
+  if (column < 0)
+    return 0;
+
+  return qint64(sqlite3_column_int64(statement, column));
+}
+
+QByteArray SqliteStatement::readBlob(const int column) const
+{
+  if (isNull(column))
+    return QByteArray();
+
+  const char* data = static_cast<const char*>(sqlite3_column_blob(statement, column));
+  return QByteArray(data, sqlite3_column_bytes(statement, column));
+}
+
+QString SqliteStatement::readText(const int column) const
+{
+  if (isNull(column))
+    return QString();
+
+  const char* text = reinterpret_cast<const char*>(sqlite3_column_text(statement, column));
+  return QString::fromUtf8(text, sqlite3_column_bytes(statement, column));
+}
+
+sqlite3_stmt* SqliteStatement::handle() const
+{
+  return statement;
+}
+
+void SqliteStatement::checkBindResult(const int resultCode) const
+{
+  if (resultCode != SQLITE_OK)
+    throw SQLErrorException(resultCode, sqlite3_errmsg(connection.handle()));
+}
@@ -0,0 +1,78 @@
+#ifndef SQLITECONNECTION_H
+#define SQLITECONNECTION_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include "exceptions.h"
+#include "sqlite3.h"
+
+class SqliteConnection
+{
+public:
+  SqliteConnection() = default;
+  ~SqliteConnection();
+
+  void open(const QString& filename, const bool readOnly = false);
+  void close();
+
+  bool isOpen() const;
+  QString getFilename() const;
+  sqlite3* handle() const;
+
+  void execute(const char* sql);
+  sqlite3_stmt* prepare(const char* sql);
+
+  uint lastInsertRowId() const;
+
+private:
+  Q_DISABLE_COPY(SqliteConnection)
+
+  QString filename;
+  bool readOnly = false;
+  sqlite3* db = nullptr;
+
+  // Prepared statements are kept for the lifetime of the connection and keyed by their sql text
+  QHash<QByteArray, sqlite3_stmt*> statements;
+};
+
+class SqliteStatement
+{
+public:
+  SqliteStatement(SqliteConnection& connection, const char* sql);
+  ~SqliteStatement();
+
+  void bind(const int parameter, const int value);
+  void bind(const int parameter, const uint value);
+  void bind(const int parameter, const qint64 value);
+  void bind(const int parameter, const QString& value);
+  void bind(const int parameter, const QByteArray& value);
+
+  bool step();
+  void reset();
+
+  int columnIndex(const char* name) const;
+  bool isNull(const int column) const;
+  bool readBool(const int column) const;
+  int readInt(const int column) const;
+  uint readUInt(const int column) const;
+  qint64 readInt64(const int column) const;
+  QByteArray readBlob(const int column) const;
+  QString readText(const int column) const;
+
+  sqlite3_stmt* handle() const;
+
+private:
+  Q_DISABLE_COPY(SqliteStatement)
+
+  SqliteConnection& connection;
+  sqlite3_stmt* statement;
+
+  // Bound text has to outlive the step, so we keep the utf8 copies of bound QStrings here
+  QList<QByteArray> boundText;
+
+  void checkBindResult(const int resultCode) const;
+};
+
+#endif // SQLITECONNECTION_H
@@ -1,7 +1,10 @@
 #include "track.h"
 
 Track::Track(QObject *parent) :
-  QObject(parent)
+  QObject(parent),
+  prefabRegistry(new PrefabRegistry()),
+  store(prefabRegistry),
+  spatialIndex(store)
 {
 
 }
@@ -35,17 +38,26 @@ void Track::addObject(EditorObject* object)
   if (!object)
     return;
 
-  object->setParent(this);
-
   objects.append(object);
 
   if (object->isGate())
     gates.append(object);      
 }
 
+bool Track::removeObject(EditorObject* object)
+{
+  if (!objects.removeOne(object))
+    return false;
+
+  // Removed objects might still be referenced elsewhere, they stay in the pool until the track goes away
+  gates.removeOne(object);
+
+  return true;
+}
+
 int Track::getAvailablePrefabCount() const
 {
-  return availablePrefabs.count();
+  return prefabRegistry->count();
 }
 
 int Track::getGateCount() const
@@ -73,6 +85,47 @@ WeatherData& Track::Weather()
   return weather;
 }
 
+bool Track::hasWeather() const
+{
+  return weatherSet;
+}
+
+void Track::setHasWeather(const bool value)
+{
+  weatherSet = value;
+}
+
+const QByteArray& Track::getSourceData() const
+{
+  return sourceData;
+}
+
+void Track::setSourceData(const QByteArray& value)
+{
+  sourceData = value;
+}
+
+int Track::getWeatherSourceOffset() const
+{
+  return weatherSourceOffset;
+}
+
+int Track::getWeatherSourceLength() const
+{
+  return weatherSourceLength;
+}
+
+void Track::setWeatherSourceSpan(const int offset, const int length)
+{
+  weatherSourceOffset = offset;
+  weatherSourceLength = length;
+}
+
+QVector<JsonSourceMember>& Track::getUnknownMembers()
+{
+  return unknownMembers;
+}
+
 QVector<EditorObject*> Track::getObjects() const
 {
   return objects;
@@ -83,14 +136,33 @@ int Track::getObjectCount() const
   return objects.count();
 }
 
-QVector<PrefabData> Track::getAvailablePrefabs() const
+const QVector<PrefabData>& Track::getAvailablePrefabs() const
+{
+  return prefabRegistry->getPrefabs();
+}
+
+const PrefabRegistry& Track::getPrefabRegistry() const
+{
+  return *prefabRegistry;
+}
+
+TrackStore& Track::getStore()
 {
-    return availablePrefabs;
+  return store;
 }
 
-void Track::setAvailablePrefabs(const QVector<PrefabData> &value)
+SpatialIndex& Track::getSpatialIndex()
 {
-    availablePrefabs = value;
+  return spatialIndex;
+}
+
+void Track::setPrefabRegistry(const PrefabRegistryPtr& value)
+{
+  if (value.isNull())
+    return;
+
+  prefabRegistry = value;
+  store.setPrefabRegistry(value);
 }
 
 QVector<EditorObject *> Track::getGates() const
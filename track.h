@@ -4,24 +4,27 @@
 #include <QObject>
 
 #include "editorobject.h"
+#include "prefabregistry.h"
+#include "spatialindex.h"
+#include "trackstore.h"
 #include "velodb.h"
 
 struct WeatherData
 {
-  double cloud;
-  double dambient;
-  double dlight;
-  double dshadow;
-  bool fog;
-  double hour;
-  double latitude;
-  double longitude;
-  char month;
-  double nambient;
-  double nlight;
-  double nshadow;
-  bool time;
-  double utc;
+  double cloud = 0;
+  double dambient = 0;
+  double dlight = 0;
+  double dshadow = 0;
+  bool fog = false;
+  double hour = 0;
+  double latitude = 0;
+  double longitude = 0;
+  char month = 0;
+  double nambient = 0;
+  double nlight = 0;
+  double nshadow = 0;
+  bool time = false;
+  double utc = 0;
 };
 
 class EditorObject;
@@ -37,27 +40,50 @@ public:
 //  Track& operator = (const Track& b);
 
   void                    addObject(EditorObject* object);
+  bool                    removeObject(EditorObject* object);
 
-  QVector<PrefabData>     getAvailablePrefabs() const;
+  const QVector<PrefabData>& getAvailablePrefabs() const;
   int                     getGateCount() const;
   QVector<EditorObject*>  getObjects() const;
   int                     getObjectCount() const;
   int                     getAvailablePrefabCount() const;
   int                     getSplineCount() const;
+  const PrefabRegistry&   getPrefabRegistry() const;
+  SpatialIndex&           getSpatialIndex();
+  TrackStore&             getStore();
   TrackData&              getTrackData();
   void                    setTrackData(const TrackData& value);
   WeatherData&            Weather();
+  bool                    hasWeather() const;
+  void                    setHasWeather(const bool value);
 
-  void                    setAvailablePrefabs(const QVector<PrefabData>& value);
+  const QByteArray&       getSourceData() const;
+  void                    setSourceData(const QByteArray& value);
+  int                     getWeatherSourceOffset() const;
+  int                     getWeatherSourceLength() const;
+  void                    setWeatherSourceSpan(const int offset, const int length);
+  QVector<JsonSourceMember>& getUnknownMembers();
+
+  void                    setPrefabRegistry(const PrefabRegistryPtr& value);
 
   QVector<EditorObject*>  getGates() const;
 
 private:
-  QVector<PrefabData>     availablePrefabs;
+  PrefabRegistryPtr       prefabRegistry;
+  TrackStore              store;
+  SpatialIndex            spatialIndex;
   QVector<EditorObject*>  gates;
   QVector<EditorObject*>  objects;
   TrackData               trackData;
   WeatherData             weather;
+  bool                    weatherSet = false;
+
+  // The json the object spans refer to, unchanged objects are copied from here on export
+  QByteArray              sourceData;
+  int                     weatherSourceOffset = -1;
+  int                     weatherSourceLength = 0;
+  // Root members besides barriers, gates and weather
+  QVector<JsonSourceMember> unknownMembers;
 };
 
 #endif // TRACK_H
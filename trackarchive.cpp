@@ -10,9 +10,12 @@ TrackArchive::TrackArchive(QObject *parent)
 void TrackArchive::archiveTrack(TrackData &trackData)
 {
   trackData.assignedDatabase = archiveDb->getDatabaseType();
-  archiveDb->saveTrack(trackData, true);
+  trackData.id = archiveDb->saveTrack(trackData, true);
 
-  tracks.append(trackData);
+  // The archive list is a catalog only, the json is reloaded on restore
+  TrackData catalogEntry = trackData;
+  catalogEntry.value.clear();
+  tracks.append(catalogEntry);
 }
 
 TrackData TrackArchive::restoreTrack(TrackData &trackData)
@@ -20,6 +23,7 @@ TrackData TrackArchive::restoreTrack(TrackData &trackData)
   for(int i = 0; i < tracks.count(); ++i) {
     TrackData restoredTrack = tracks.at(i);
     if (restoredTrack == trackData) {
+      archiveDb->loadTrackValue(restoredTrack);
       archiveDb->deleteTrack(restoredTrack);
       tracks.removeAt(i);
 
@@ -50,7 +54,7 @@ void TrackArchive::setFileName(const QString &value)
   queryTracks();
 }
 
-QVector<TrackData> TrackArchive::getTracks() const
+const QVector<TrackData>& TrackArchive::getTracks() const
 {
   return tracks;
 }
@@ -65,7 +69,7 @@ void TrackArchive::queryTracks()
   tracks.clear();
 
   try {
-    archiveDb->queryTracks();
+    archiveDb->refreshTracks();
   } catch (NoDatabasesFileNameException& e) {
     Q_UNUSED(e)
   }
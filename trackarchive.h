@@ -20,7 +20,7 @@ public:
   QString getFileName() const;
   void setFileName(const QString &value);
 
-  QVector<TrackData> getTracks() const;
+  const QVector<TrackData>& getTracks() const;
   void setTracks(const QVector<TrackData> &value);
 
 private:
@@ -0,0 +1,328 @@
+#include "trackcache.h"
+
+#include <cstring>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "editorobject.h"
+#include "track.h"
+
+static const char cacheMagic[4] = { 'V', 'T', 'C', 'F' };
+
+TrackCache::TrackCache(const QString& directory) :
+  directory(directory)
+{
+}
+
+QString TrackCache::getDefaultDirectory()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/tracks";
+}
+
+QByteArray TrackCache::hashTrackData(const QByteArray& value)
+{
+  return QCryptographicHash::hash(value, QCryptographicHash::Md5);
+}
+
+Track* TrackCache::load(const PrefabRegistryPtr& prefabs, const TrackData& trackData, const QString& databaseFilename, const QByteArray& contentHash) const
+{
+  QFile file(getFilename(trackData, databaseFilename));
+  if (!file.open(QIODevice::ReadOnly) || (file.size() < qint64(sizeof(FileHeader))))
+    return nullptr;
+
+  // The file is mapped and read in place, the records never get copied into a buffer of their own
+  const qint64 fileSize = file.size();
+  const uchar* data = file.map(0, fileSize);
+  if (data == nullptr)
+    return nullptr;
+
+  const FileHeader* header = reinterpret_cast<const FileHeader*>(data);
+  if ((memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) != 0) ||
+      (header->version != formatVersion) ||
+      (contentHash.size() != int(sizeof(header->contentHash))) ||
+      (memcmp(header->contentHash, contentHash.constData(), sizeof(header->contentHash)) != 0) ||
+      (header->sourceLength != uint(trackData.value.size())) ||
+      (fileSize != qint64(sizeof(FileHeader)) +
+                   qint64(header->objectCount) * qint64(sizeof(ObjectRecord)) +
+                   qint64(header->linkCount) * qint64(sizeof(LinkRecord)) +
+                   qint64(header->memberCount) * qint64(sizeof(MemberRecord)))) {
+    return nullptr;
+  }
+
+  const ObjectRecord* records = reinterpret_cast<const ObjectRecord*>(data + sizeof(FileHeader));
+  const int objectCount = int(header->objectCount);
+  const LinkRecord* linkRecords = reinterpret_cast<const LinkRecord*>(records + objectCount);
+  const int linkCount = int(header->linkCount);
+  const MemberRecord* memberRecords = reinterpret_cast<const MemberRecord*>(linkRecords + linkCount);
+  const int memberCount = int(header->memberCount);
+
+  Track* track = new Track();
+  track->setPrefabRegistry(prefabs);
+  track->setTrackData(trackData);
+  track->setSourceData(trackData.value);
+
+  if (header->hasWeather) {
+    WeatherData& weather = track->Weather();
+    weather.cloud = header->weatherCloud;
+    weather.dambient = header->weatherDambient;
+    weather.dlight = header->weatherDlight;
+    weather.dshadow = header->weatherDshadow;
+    weather.fog = header->weatherFog != 0;
+    weather.hour = header->weatherHour;
+    weather.latitude = header->weatherLatitude;
+    weather.longitude = header->weatherLongitude;
+    weather.month = char(header->weatherMonth);
+    weather.nambient = header->weatherNambient;
+    weather.nlight = header->weatherNlight;
+    weather.nshadow = header->weatherNshadow;
+    weather.time = header->weatherTime != 0;
+    weather.utc = header->weatherUtc;
+    track->setHasWeather(true);
+    track->setWeatherSourceSpan(header->weatherSourceOffset, header->weatherSourceLength);
+  }
+
+  QVector<EditorObject*> objects(objectCount, nullptr);
+  for (int i = 0; i < objectCount; ++i) {
+    const ObjectRecord& record = records[i];
+
+    // A prefab that vanished from the settings database or a broken parent link invalidates the whole file
+    const PrefabData* prefab = prefabs->find(record.prefabId);
+    const bool validParent = (record.relation == TrackObject) ? (record.parent == -1) :
+                                                                 (record.relation <= SplineParent && record.parent >= 0 && record.parent < i);
+    if ((prefab == nullptr) || !validParent) {
+      // Every object created so far is already linked into the track, which cleans them up
+      delete track;
+      return nullptr;
+    }
+
+    EditorObject* object = track->getStore().createObject();
+    object->setData(*prefab);
+    object->setPosition(record.position[0], record.position[1], record.position[2]);
+    object->setRotation(record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3]);
+    object->setScaling(record.scaling[0], record.scaling[1], record.scaling[2]);
+    object->setGateNo(record.gateNo, false);
+    object->setFinish(record.flags & Finish);
+    object->setStart(record.flags & Start);
+    object->setSplineGroupCount(record.splineGroupCount);
+    for (uint flag = EditorObject::HasCurveKey; flag <= EditorObject::StoredInGates; flag <<= 1) {
+      if (record.jsonLayout & flag)
+        object->setJsonLayoutFlag(EditorObject::JsonLayoutFlag(flag));
+    }
+    object->setModified(false);
+    object->setSourceSpan(record.sourceOffset, record.sourceLength);
+    objects[i] = object;
+
+    EditorObject* parent = (record.relation == TrackObject) ? nullptr : objects.at(record.parent);
+    switch (record.relation) {
+    case SplineControl:
+      parent->getSplineControls().append(object);
+      break;
+    case SplineObject:
+      parent->getSplineObjects().append(object);
+      break;
+    case SplineParent:
+      parent->getSplineParents().append(object);
+      break;
+    default:
+      track->addObject(object);
+      break;
+    }
+    object->setParentObject(parent);
+  }
+
+  for (int i = 0; i < linkCount; ++i) {
+    const LinkRecord& record = linkRecords[i];
+
+    // Both sides of a link have to be children of the spline that owns it
+    const bool validOwner = (record.owner >= 0 && record.owner < objectCount);
+    const bool validObject = (record.object == -1) ||
+                             (validOwner && record.object > record.owner && record.object < objectCount &&
+                              objects.at(record.object)->getParentObject() == objects.at(record.owner));
+    const bool validParent = (record.parent == -1) ||
+                             (validOwner && record.parent > record.owner && record.parent < objectCount &&
+                              objects.at(record.parent)->getParentObject() == objects.at(record.owner));
+    if (!validOwner || !validObject || !validParent) {
+      delete track;
+      return nullptr;
+    }
+
+    SplineLink link;
+    link.group = record.group;
+    link.index = record.index;
+    link.isMoving = record.isMoving != 0;
+    link.speed = char(record.speed);
+    link.jsonLayout = record.jsonLayout;
+    link.object = (record.object == -1) ? nullptr : objects.at(record.object);
+    link.parent = (record.parent == -1) ? nullptr : objects.at(record.parent);
+    objects.at(record.owner)->getSplineLinks().append(link);
+  }
+
+  for (int i = 0; i < memberCount; ++i) {
+    const MemberRecord& record = memberRecords[i];
+    if (record.owner < -1 || record.owner >= objectCount) {
+      delete track;
+      return nullptr;
+    }
+
+    JsonSourceMember member;
+    member.scope = record.scope;
+    member.scopeIndex = record.scopeIndex;
+    member.keyOffset = record.keyOffset;
+    member.keyLength = record.keyLength;
+    member.valueOffset = record.valueOffset;
+    member.valueLength = record.valueLength;
+    if (record.owner == -1)
+      track->getUnknownMembers().append(member);
+    else
+      objects.at(record.owner)->getUnknownMembers().append(member);
+  }
+
+  return track;
+}
+
+bool TrackCache::store(Track& track, const QString& databaseFilename, const QByteArray& contentHash) const
+{
+  if (contentHash.size() != int(sizeof(FileHeader::contentHash)))
+    return false;
+
+  QVector<ObjectRecord> records;
+  QVector<LinkRecord> links;
+  QVector<MemberRecord> members;
+  records.reserve(track.getObjectCount());
+  appendMembers(members, track.getUnknownMembers(), -1);
+  foreach(EditorObject* object, track.getObjects())
+    appendObject(records, links, members, object, -1, TrackObject);
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+  header.version = formatVersion;
+  memcpy(header.contentHash, contentHash.constData(), sizeof(header.contentHash));
+  header.objectCount = quint32(records.count());
+  header.linkCount = quint32(links.count());
+  header.memberCount = quint32(members.count());
+  header.sourceLength = quint32(track.getSourceData().size());
+  header.weatherSourceOffset = track.getWeatherSourceOffset();
+  header.weatherSourceLength = track.getWeatherSourceLength();
+  if (track.hasWeather()) {
+    const WeatherData& weather = track.Weather();
+    header.hasWeather = 1;
+    header.weatherCloud = weather.cloud;
+    header.weatherDambient = weather.dambient;
+    header.weatherDlight = weather.dlight;
+    header.weatherDshadow = weather.dshadow;
+    header.weatherFog = weather.fog ? 1 : 0;
+    header.weatherHour = weather.hour;
+    header.weatherLatitude = weather.latitude;
+    header.weatherLongitude = weather.longitude;
+    header.weatherMonth = qint8(weather.month);
+    header.weatherNambient = weather.nambient;
+    header.weatherNlight = weather.nlight;
+    header.weatherNshadow = weather.nshadow;
+    header.weatherTime = weather.time ? 1 : 0;
+    header.weatherUtc = weather.utc;
+  }
+
+  if (!QDir().mkpath(directory))
+    return false;
+
+  // Write to a temporary file first, so a crash never leaves a half written cache behind
+  QSaveFile file(getFilename(track.getTrackData(), databaseFilename));
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(records.constData()), qint64(records.count()) * qint64(sizeof(ObjectRecord)));
+  file.write(reinterpret_cast<const char*>(links.constData()), qint64(links.count()) * qint64(sizeof(LinkRecord)));
+  file.write(reinterpret_cast<const char*>(members.constData()), qint64(members.count()) * qint64(sizeof(MemberRecord)));
+
+  return file.commit();
+}
+
+QString TrackCache::getFilename(const TrackData& trackData, const QString& databaseFilename) const
+{
+  // Track ids are only unique within one database file, so its absolute path is part of the name, like for the track index
+  const QByteArray path = QFileInfo(databaseFilename).absoluteFilePath().toUtf8();
+  const QString databaseHash = QCryptographicHash::hash(path, QCryptographicHash::Md5).toHex();
+  return QString("%1/%2-%3-%4.vtc").arg(directory).arg(databaseHash).arg(int(trackData.assignedDatabase)).arg(trackData.id);
+}
+
+void TrackCache::appendObject(QVector<ObjectRecord>& records, QVector<LinkRecord>& links, QVector<MemberRecord>& members,
+                              EditorObject* object, const int parent, const ObjectRelation relation)
+{
+  ObjectRecord record;
+  memset(&record, 0, sizeof(record));
+  record.prefabId = object->getId();
+  record.parent = parent;
+  record.relation = relation;
+  record.flags = quint8((object->getFinish() ? Finish : 0) |
+                        (object->getStart() ? Start : 0));
+  for (uint flag = EditorObject::HasCurveKey; flag <= EditorObject::StoredInGates; flag <<= 1) {
+    if (object->hasJsonLayoutFlag(EditorObject::JsonLayoutFlag(flag)))
+      record.jsonLayout |= quint8(flag);
+  }
+  for (int i = 0; i < 3; ++i) {
+    record.position[i] = object->getPosition(i);
+    record.scaling[i] = object->getScaling(i);
+  }
+  for (int i = 0; i < 4; ++i)
+    record.rotation[i] = object->getRotationVector(i);
+  record.gateNo = object->getGateNo();
+  record.splineGroupCount = object->getSplineGroupCount();
+  record.sourceOffset = object->getSourceOffset();
+  record.sourceLength = object->getSourceLength();
+
+  const int index = records.count();
+  records.append(record);
+  appendMembers(members, object->getUnknownMembers(), index);
+
+  foreach(EditorObject* child, object->getSplineControls())
+    appendObject(records, links, members, child, index, SplineControl);
+
+  // The links refer to the records of the children, so remember where each of them ends up
+  QHash<EditorObject*, int> childRecords;
+  foreach(EditorObject* child, object->getSplineObjects()) {
+    childRecords.insert(child, records.count());
+    appendObject(records, links, members, child, index, SplineObject);
+  }
+
+  foreach(EditorObject* child, object->getSplineParents()) {
+    childRecords.insert(child, records.count());
+    appendObject(records, links, members, child, index, SplineParent);
+  }
+
+  foreach(const SplineLink& link, object->getSplineLinks()) {
+    LinkRecord linkRecord;
+    memset(&linkRecord, 0, sizeof(linkRecord));
+    linkRecord.owner = index;
+    linkRecord.group = link.group;
+    linkRecord.index = link.index;
+    linkRecord.object = childRecords.value(link.object, -1);
+    linkRecord.parent = childRecords.value(link.parent, -1);
+    linkRecord.jsonLayout = link.jsonLayout;
+    linkRecord.isMoving = link.isMoving ? 1 : 0;
+    linkRecord.speed = qint8(link.speed);
+    links.append(linkRecord);
+  }
+}
+
+void TrackCache::appendMembers(QVector<MemberRecord>& records, const QVector<JsonSourceMember>& members, const int owner)
+{
+  foreach(const JsonSourceMember& member, members) {
+    MemberRecord record;
+    memset(&record, 0, sizeof(record));
+    record.owner = owner;
+    record.scope = member.scope;
+    record.scopeIndex = member.scopeIndex;
+    record.keyOffset = member.keyOffset;
+    record.keyLength = member.keyLength;
+    record.valueOffset = member.valueOffset;
+    record.valueLength = member.valueLength;
+    records.append(record);
+  }
+}
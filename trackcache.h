@@ -0,0 +1,126 @@
+#ifndef TRACKCACHE_H
+#define TRACKCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "editorobject.h"
+#include "prefabregistry.h"
+#include "velodb.h"
+
+class Track;
+
+// Keeps the parsed object table of a track on disk, so re-opening an unchanged track skips the json parser.
+// A cache file is keyed by database file, database type and track id and only used if the hash of the track json still matches.
+class TrackCache
+{
+public:
+  explicit TrackCache(const QString& directory = getDefaultDirectory());
+
+  static QString getDefaultDirectory();
+  static QByteArray hashTrackData(const QByteArray& value);
+
+  Track* load(const PrefabRegistryPtr& prefabs, const TrackData& trackData, const QString& databaseFilename, const QByteArray& contentHash) const;
+  bool store(Track& track, const QString& databaseFilename, const QByteArray& contentHash) const;
+
+private:
+  // Bump this whenever one of the records below changes
+  static const quint32 formatVersion = 2;
+
+  struct FileHeader
+  {
+    char magic[4];
+    quint32 version;
+    char contentHash[16];
+    quint32 objectCount;
+    quint32 linkCount;
+    quint32 memberCount;
+    quint32 sourceLength;
+    qint32 weatherSourceOffset;
+    qint32 weatherSourceLength;
+    quint8 hasWeather;
+    quint8 weatherFog;
+    quint8 weatherTime;
+    qint8 weatherMonth;
+    quint32 reserved;
+    double weatherCloud;
+    double weatherDambient;
+    double weatherDlight;
+    double weatherDshadow;
+    double weatherHour;
+    double weatherLatitude;
+    double weatherLongitude;
+    double weatherNambient;
+    double weatherNlight;
+    double weatherNshadow;
+    double weatherUtc;
+  };
+
+  enum ObjectRelation : quint8 {
+    TrackObject = 0,
+    SplineControl = 1,
+    SplineObject = 2,
+    SplineParent = 3
+  };
+
+  enum ObjectFlag : quint8 {
+    Finish = 0x01,
+    Start = 0x02
+  };
+
+  // The objects are stored depth first, so a parent is always created before its children
+  struct ObjectRecord
+  {
+    quint32 prefabId;
+    qint32 parent;
+    quint8 relation;
+    quint8 flags;
+    quint8 reserved;
+    quint8 jsonLayout;
+    qint32 position[3];
+    qint32 rotation[4];
+    qint32 scaling[3];
+    qint32 gateNo;
+    qint32 splineGroupCount;
+    qint32 sourceOffset;
+    qint32 sourceLength;
+  };
+
+  // One lojb entry of a spline, the sides point to object records of the owner's children or are -1
+  struct LinkRecord
+  {
+    qint32 owner;
+    qint32 group;
+    qint32 index;
+    qint32 object;
+    qint32 parent;
+    quint8 jsonLayout;
+    quint8 isMoving;
+    qint8 speed;
+    quint8 reserved;
+  };
+
+  // A json member the parser did not know, the owner is -1 for the root of the track
+  struct MemberRecord
+  {
+    qint32 owner;
+    quint8 scope;
+    quint8 reserved[3];
+    qint32 scopeIndex;
+    qint32 keyOffset;
+    qint32 keyLength;
+    qint32 valueOffset;
+    qint32 valueLength;
+  };
+
+  QString directory;
+
+  QString getFilename(const TrackData& trackData, const QString& databaseFilename) const;
+
+  static void appendObject(QVector<ObjectRecord>& records, QVector<LinkRecord>& links, QVector<MemberRecord>& members,
+                           EditorObject* object, const int parent, const ObjectRelation relation);
+  static void appendMembers(QVector<MemberRecord>& records, const QVector<JsonSourceMember>& members, const int owner);
+};
+
+#endif // TRACKCACHE_H
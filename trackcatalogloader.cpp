@@ -0,0 +1,57 @@
+#include "trackcatalogloader.h"
+
+TrackCatalogLoader::TrackCatalogLoader(const DatabaseType databaseType, const QString& userDbFilename, QObject* parent) :
+  QThread(parent),
+  databaseType(databaseType),
+  userDbFilename(userDbFilename)
+{
+  qRegisterMetaType<QVector<TrackData>>("QVector<TrackData>");
+}
+
+TrackCatalogLoader::~TrackCatalogLoader()
+{
+  cancel();
+}
+
+void TrackCatalogLoader::cancel()
+{
+  // The loader checks for the interruption after every row, so this won't block for long
+  requestInterruption();
+  wait();
+}
+
+void TrackCatalogLoader::run()
+{
+  QVector<TrackData> batch;
+  batch.reserve(batchSize);
+
+  try {
+    // The worker gets its own read only connection, sqlite connections must not be shared between threads
+    SqliteConnection connection;
+    connection.open(userDbFilename, true);
+
+    SqliteStatement statement(connection, VeloDb::trackCatalogQuery);
+    while (statement.step()) {
+      if (isInterruptionRequested())
+        return;
+
+      batch.append(VeloDb::readTrackCatalogRow(statement, databaseType));
+      if (batch.count() == batchSize) {
+        emit tracksLoaded(batch);
+        batch.clear();
+        batch.reserve(batchSize);
+      }
+    }
+  } catch (VeloToolkitException& e) {
+    emit loadingFailed(e);
+    return;
+  }
+
+  if (isInterruptionRequested())
+    return;
+
+  if (!batch.isEmpty())
+    emit tracksLoaded(batch);
+
+  emit loadingFinished();
+}
@@ -0,0 +1,37 @@
+#ifndef TRACKCATALOGLOADER_H
+#define TRACKCATALOGLOADER_H
+
+#include <QThread>
+#include <QVector>
+
+#include "exceptions.h"
+#include "sqliteconnection.h"
+#include "velodb.h"
+
+class TrackCatalogLoader : public QThread
+{
+  Q_OBJECT
+
+public:
+  TrackCatalogLoader(const DatabaseType databaseType, const QString& userDbFilename, QObject* parent = nullptr);
+  ~TrackCatalogLoader();
+
+  void cancel();
+
+signals:
+  void tracksLoaded(const QVector<TrackData>& tracks);
+  void loadingFinished();
+  void loadingFailed(const QString& errorMessage);
+
+protected:
+  void run() override;
+
+private:
+  // Number of tracks that are read before they are handed to the ui thread
+  static const int batchSize = 250;
+
+  DatabaseType databaseType;
+  QString userDbFilename;
+};
+
+#endif // TRACKCATALOGLOADER_H
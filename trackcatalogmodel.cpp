@@ -0,0 +1,114 @@
+#include "trackcatalogmodel.h"
+
+TrackCatalogModel::TrackCatalogModel(QObject* parent) :
+  QAbstractTableModel(parent)
+{
+}
+
+void TrackCatalogModel::appendTracks(const QVector<TrackData>& newTracks)
+{
+  if (newTracks.isEmpty())
+    return;
+
+  beginInsertRows(QModelIndex(), tracks.count(), tracks.count() + newTracks.count() - 1);
+  tracks.append(newTracks);
+  endInsertRows();
+}
+
+void TrackCatalogModel::clear(const VeloDb* database)
+{
+  beginResetModel();
+  this->database = database;
+  tracks.clear();
+  summaries.clear();
+  endResetModel();
+}
+
+TrackData TrackCatalogModel::getTrack(const int row) const
+{
+  if (row < 0 || row >= tracks.count())
+    return TrackData();
+
+  return tracks[row];
+}
+
+const QVector<TrackData>& TrackCatalogModel::getTracks() const
+{
+  return tracks;
+}
+
+void TrackCatalogModel::setSummaries(const QHash<uint, TrackSummary>& value)
+{
+  summaries = value;
+
+  if (!tracks.isEmpty())
+    emit dataChanged(index(0, TrackTreeColumns::GatesColumn), index(tracks.count() - 1, TrackTreeColumns::ObjectsColumn));
+}
+
+int TrackCatalogModel::columnCount(const QModelIndex& parent) const
+{
+  if (parent.isValid())
+    return 0;
+
+  return 4;
+}
+
+QVariant TrackCatalogModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid() || index.row() >= tracks.count())
+    return QVariant();
+
+  const TrackData& track = tracks[index.row()];
+
+  switch (role) {
+  case Qt::DisplayRole:
+    if (index.column() == TrackTreeColumns::NameColumn)
+      return track.name;
+
+    if (index.column() == TrackTreeColumns::SceneColumn) {
+      // Fall back to the scene id, if we can't resolve the scene
+      const SceneData scene = database != nullptr ? database->getScene(track.sceneId) : SceneData();
+      return scene.id != 0 ? scene.title : QString::number(track.sceneId);
+    }
+
+    if (index.column() == TrackTreeColumns::GatesColumn || index.column() == TrackTreeColumns::ObjectsColumn) {
+      QHash<uint, TrackSummary>::const_iterator summary = summaries.constFind(track.id);
+      if (summary == summaries.constEnd() || summary->invalid)
+        return QVariant();
+
+      return index.column() == TrackTreeColumns::GatesColumn ? summary->gateCount : summary->objectCount;
+    }
+    break;
+  case Qt::UserRole:
+    return QVariant::fromValue(track);
+  }
+
+  return QVariant();
+}
+
+QVariant TrackCatalogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+
+  switch (section) {
+  case TrackTreeColumns::NameColumn:
+    return tr("Name");
+  case TrackTreeColumns::SceneColumn:
+    return tr("Scene");
+  case TrackTreeColumns::GatesColumn:
+    return tr("Gates");
+  case TrackTreeColumns::ObjectsColumn:
+    return tr("Objects");
+  }
+
+  return QVariant();
+}
+
+int TrackCatalogModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.isValid())
+    return 0;
+
+  return tracks.count();
+}
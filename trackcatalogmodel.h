@@ -0,0 +1,43 @@
+#ifndef TRACKCATALOGMODEL_H
+#define TRACKCATALOGMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "trackindex.h"
+#include "velodb.h"
+
+enum TrackTreeColumns {
+  NameColumn = 0,
+  SceneColumn = 1,
+  GatesColumn = 2,
+  ObjectsColumn = 3
+};
+
+class TrackCatalogModel : public QAbstractTableModel
+{
+  Q_OBJECT
+
+public:
+  TrackCatalogModel(QObject* parent = nullptr);
+
+  void appendTracks(const QVector<TrackData>& newTracks);
+  void clear(const VeloDb* database = nullptr);
+  TrackData getTrack(const int row) const;
+  const QVector<TrackData>& getTracks() const;
+  void setSummaries(const QHash<uint, TrackSummary>& value);
+
+  int       columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant  data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant  headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+  int       rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+private:
+  const VeloDb* database = nullptr;
+  QVector<TrackData> tracks;
+
+  // From the track index, tracks that have not been indexed yet have no summary
+  QHash<uint, TrackSummary> summaries;
+};
+
+#endif // TRACKCATALOGMODEL_H
@@ -0,0 +1,378 @@
+#include "trackindex.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include "jsonreader.h"
+
+TrackIndex::TrackIndex(const QString& userDbFilename, const QString& directory)
+{
+  // One index per user database file, named after its absolute path
+  const QByteArray path = QFileInfo(userDbFilename).absoluteFilePath().toUtf8();
+  filename = directory + "/" + QCryptographicHash::hash(path, QCryptographicHash::Md5).toHex() + ".sqlite";
+}
+
+QString TrackIndex::getDefaultDirectory()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/index";
+}
+
+QString TrackIndex::getFilename() const
+{
+  return filename;
+}
+
+void TrackIndex::open()
+{
+  if (connection.isOpen())
+    return;
+
+  QDir().mkpath(QFileInfo(filename).absolutePath());
+  connection.open(filename);
+
+  // The dialog reads the index while the indexer is writing to it
+  connection.execute("PRAGMA journal_mode=WAL;");
+  connection.execute("PRAGMA synchronous=NORMAL;");
+
+  int version = 0;
+  {
+    SqliteStatement statement(connection, "PRAGMA user_version;");
+    if (statement.step())
+      version = statement.readInt(0);
+  }
+
+  if (version != formatVersion)
+    createTables();
+}
+
+void TrackIndex::createTables()
+{
+  connection.execute("DROP TABLE IF EXISTS catalog_stamp;");
+  connection.execute("DROP TABLE IF EXISTS file_stamp;");
+  connection.execute("DROP TABLE IF EXISTS track_prefabs;");
+  connection.execute("DROP TABLE IF EXISTS tracks;");
+
+  connection.execute("CREATE TABLE tracks ("
+                     "id INTEGER NOT NULL PRIMARY KEY,"
+                     "content_hash TEXT NOT NULL,"
+                     "object_count INTEGER NOT NULL,"
+                     "gate_count INTEGER NOT NULL,"
+                     "spline_count INTEGER NOT NULL,"
+                     "has_start INTEGER NOT NULL,"
+                     "has_finish INTEGER NOT NULL,"
+                     "invalid INTEGER NOT NULL);");
+  connection.execute("CREATE INDEX tracks_gate_count ON tracks (gate_count);");
+
+  // Keyed by prefab first, so all tracks of a prefab are one range of the table
+  connection.execute("CREATE TABLE track_prefabs ("
+                     "prefab_id INTEGER NOT NULL,"
+                     "track_id INTEGER NOT NULL,"
+                     "count INTEGER NOT NULL,"
+                     "PRIMARY KEY (prefab_id, track_id)) WITHOUT ROWID;");
+  connection.execute("CREATE INDEX track_prefabs_track ON track_prefabs (track_id);");
+
+  // One row, the user database as it was when the index was last brought up to date
+  connection.execute("CREATE TABLE file_stamp ("
+                     "id INTEGER NOT NULL PRIMARY KEY CHECK (id=0),"
+                     "file_size INTEGER NOT NULL,"
+                     "last_modified INTEGER NOT NULL,"
+                     "wal_size INTEGER NOT NULL,"
+                     "wal_last_modified INTEGER NOT NULL);");
+
+  connection.execute(QString("PRAGMA user_version=%1;").arg(formatVersion).toUtf8().constData());
+}
+
+QHash<uint, QByteArray> TrackIndex::readContentHashes()
+{
+  QHash<uint, QByteArray> hashes;
+
+  SqliteStatement statement(connection, "SELECT id, content_hash FROM tracks;");
+  while (statement.step())
+    hashes.insert(statement.readUInt(0), QByteArray::fromHex(statement.readBlob(1)));
+
+  return hashes;
+}
+
+DatabaseFileStamp TrackIndex::readFileStamp()
+{
+  // Without a row the stamp matches no database, so the indexer runs
+  DatabaseFileStamp stamp;
+
+  SqliteStatement statement(connection, "SELECT file_size, last_modified, wal_size, wal_last_modified FROM file_stamp WHERE id=0;");
+  if (statement.step()) {
+    stamp.fileSize = statement.readInt64(0);
+    stamp.lastModified = statement.readInt64(1);
+    stamp.walSize = statement.readInt64(2);
+    stamp.walLastModified = statement.readInt64(3);
+  }
+
+  return stamp;
+}
+
+void TrackIndex::storeFileStamp(const DatabaseFileStamp& stamp)
+{
+  SqliteStatement statement(connection, "INSERT OR REPLACE INTO file_stamp (id, file_size, last_modified, wal_size, wal_last_modified) VALUES (0, ?1, ?2, ?3, ?4);");
+  statement.bind(1, stamp.fileSize);
+  statement.bind(2, stamp.lastModified);
+  statement.bind(3, stamp.walSize);
+  statement.bind(4, stamp.walLastModified);
+  statement.step();
+}
+
+DatabaseFileStamp TrackIndex::readDatabaseFileStamp(const QString& userDbFilename)
+{
+  DatabaseFileStamp stamp;
+
+  const QFileInfo fileInfo(userDbFilename);
+  if (fileInfo.exists()) {
+    stamp.fileSize = fileInfo.size();
+    stamp.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+  }
+
+  // A missing wal file stays at -1, which is a state of its own
+  const QFileInfo walInfo(userDbFilename + "-wal");
+  if (walInfo.exists()) {
+    stamp.walSize = walInfo.size();
+    stamp.walLastModified = walInfo.lastModified().toMSecsSinceEpoch();
+  }
+
+  return stamp;
+}
+
+void TrackIndex::beginUpdate()
+{
+  connection.execute("BEGIN;");
+}
+
+void TrackIndex::commitUpdate()
+{
+  connection.execute("COMMIT;");
+}
+
+void TrackIndex::rollbackUpdate()
+{
+  connection.execute("ROLLBACK;");
+}
+
+void TrackIndex::store(const uint trackId, const QByteArray& contentHash, const TrackSummary& summary)
+{
+  remove(trackId);
+
+  // Bound text is not copied by sqlite, so it has to live until the row is written
+  const QByteArray hashText = contentHash.toHex();
+
+  {
+    SqliteStatement statement(connection, "INSERT INTO tracks (id, content_hash, object_count, gate_count, spline_count, has_start, has_finish, invalid) "
+                                          "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8);");
+    statement.bind(1, trackId);
+    statement.bind(2, hashText);
+    statement.bind(3, summary.objectCount);
+    statement.bind(4, summary.gateCount);
+    statement.bind(5, summary.splineCount);
+    statement.bind(6, int(summary.hasStart));
+    statement.bind(7, int(summary.hasFinish));
+    statement.bind(8, int(summary.invalid));
+    statement.step();
+  }
+
+  SqliteStatement statement(connection, "INSERT INTO track_prefabs (prefab_id, track_id, count) VALUES (?1, ?2, ?3);");
+  for (QHash<uint, int>::const_iterator prefab = summary.prefabCounts.constBegin(); prefab != summary.prefabCounts.constEnd(); ++prefab) {
+    statement.bind(1, prefab.key());
+    statement.bind(2, trackId);
+    statement.bind(3, prefab.value());
+    statement.step();
+    statement.reset();
+  }
+}
+
+void TrackIndex::remove(const uint trackId)
+{
+  {
+    SqliteStatement statement(connection, "DELETE FROM track_prefabs WHERE track_id=?1;");
+    statement.bind(1, trackId);
+    statement.step();
+  }
+
+  SqliteStatement statement(connection, "DELETE FROM tracks WHERE id=?1;");
+  statement.bind(1, trackId);
+  statement.step();
+}
+
+TrackSummary TrackIndex::getSummary(const uint trackId)
+{
+  TrackSummary summary;
+
+  {
+    SqliteStatement statement(connection, "SELECT object_count, gate_count, spline_count, has_start, has_finish, invalid FROM tracks WHERE id=?1;");
+    statement.bind(1, trackId);
+    if (!statement.step())
+      return summary;
+
+    summary.objectCount = statement.readInt(0);
+    summary.gateCount = statement.readInt(1);
+    summary.splineCount = statement.readInt(2);
+    summary.hasStart = statement.readBool(3);
+    summary.hasFinish = statement.readBool(4);
+    summary.invalid = statement.readBool(5);
+  }
+
+  SqliteStatement statement(connection, "SELECT prefab_id, count FROM track_prefabs WHERE track_id=?1;");
+  statement.bind(1, trackId);
+  while (statement.step())
+    summary.prefabCounts.insert(statement.readUInt(0), statement.readInt(1));
+
+  return summary;
+}
+
+QHash<uint, TrackSummary> TrackIndex::getSummaries()
+{
+  QHash<uint, TrackSummary> summaries;
+
+  SqliteStatement statement(connection, "SELECT id, object_count, gate_count, spline_count, has_start, has_finish, invalid FROM tracks;");
+  while (statement.step()) {
+    TrackSummary& summary = summaries[statement.readUInt(0)];
+    summary.objectCount = statement.readInt(1);
+    summary.gateCount = statement.readInt(2);
+    summary.splineCount = statement.readInt(3);
+    summary.hasStart = statement.readBool(4);
+    summary.hasFinish = statement.readBool(5);
+    summary.invalid = statement.readBool(6);
+  }
+
+  return summaries;
+}
+
+QVector<uint> TrackIndex::findTracksUsingPrefab(const uint prefabId, const int minimumCount)
+{
+  QVector<uint> trackIds;
+
+  SqliteStatement statement(connection, "SELECT track_id FROM track_prefabs WHERE prefab_id=?1 AND count>=?2;");
+  statement.bind(1, prefabId);
+  statement.bind(2, minimumCount);
+  while (statement.step())
+    trackIds.append(statement.readUInt(0));
+
+  return trackIds;
+}
+
+QVector<uint> TrackIndex::findTracksByGateCount(const int minimumCount, const int maximumCount)
+{
+  QVector<uint> trackIds;
+
+  SqliteStatement statement(connection, "SELECT id FROM tracks WHERE gate_count>=?1 AND gate_count<=?2;");
+  statement.bind(1, minimumCount);
+  statement.bind(2, maximumCount);
+  while (statement.step())
+    trackIds.append(statement.readUInt(0));
+
+  return trackIds;
+}
+
+TrackSummary TrackIndex::summarize(const QByteArray& trackJson, const PrefabRegistry& prefabs)
+{
+  TrackSummary summary;
+
+  // Walks the same members as the parser, but only counts what it finds
+  JsonReader reader(trackJson);
+  reader.beginObject();
+  while (reader.hasNextMember()) {
+    const QLatin1String key = reader.readKey();
+    if (key == QLatin1String("barriers") || key == QLatin1String("gates")) {
+      reader.beginArray();
+      while (reader.hasNextElement())
+        summarizePrefab(reader, prefabs, summary);
+    } else {
+      reader.skipValue();
+    }
+  }
+
+  return summary;
+}
+
+void TrackIndex::summarizePrefab(JsonReader& reader, const PrefabRegistry& prefabs, TrackSummary& summary)
+{
+  if (reader.peek() != JsonReader::ValueType::Object) {
+    reader.skipValue();
+    return;
+  }
+
+  uint prefabId = 0;
+  int gateNo = 0;
+  bool start = false;
+  bool finish = false;
+
+  reader.beginObject();
+  while (reader.hasNextMember()) {
+    const QLatin1String key = reader.readKey();
+    if (key == QLatin1String("prefab"))
+      prefabId = reader.readUInt();
+    else if (key == QLatin1String("gate"))
+      gateNo = reader.readInt();
+    else if (key == QLatin1String("start"))
+      start = reader.readBool();
+    else if (key == QLatin1String("finish"))
+      finish = reader.readBool();
+    else if (key == QLatin1String("curve"))
+      summarizeCurve(reader, prefabs, summary);
+    else
+      reader.skipValue();
+  }
+
+  // Empty objects are unused spline slots
+  if (prefabId == 0)
+    return;
+
+  quint8 capabilities = 0;
+  prefabs.find(prefabId, capabilities);
+
+  summary.objectCount++;
+  summary.prefabCounts[prefabId]++;
+  if ((capabilities & PrefabRegistry::Gate) && gateNo > 0)
+    summary.gateCount++;
+  if (capabilities & PrefabRegistry::Spline)
+    summary.splineCount++;
+  summary.hasStart |= start;
+  summary.hasFinish |= finish;
+}
+
+void TrackIndex::summarizeCurve(JsonReader& reader, const PrefabRegistry& prefabs, TrackSummary& summary)
+{
+  reader.beginObject();
+  while (reader.hasNextMember()) {
+    const QLatin1String key = reader.readKey();
+    if (key == QLatin1String("lobjs")) {
+      reader.beginArray();
+      while (reader.hasNextElement()) {
+        reader.beginObject();
+        while (reader.hasNextMember()) {
+          if (reader.readKey() != QLatin1String("lojb")) {
+            reader.skipValue();
+            continue;
+          }
+
+          // Every link holds the object on the spline and the spline parent
+          reader.beginArray();
+          while (reader.hasNextElement()) {
+            reader.beginObject();
+            while (reader.hasNextMember()) {
+              const QLatin1String linkKey = reader.readKey();
+              if (linkKey == QLatin1String("jo") || linkKey == QLatin1String("ctrlp"))
+                summarizePrefab(reader, prefabs, summary);
+              else
+                reader.skipValue();
+            }
+          }
+        }
+      }
+    } else if (key == QLatin1String("ctrls")) {
+      reader.beginArray();
+      while (reader.hasNextElement())
+        summarizePrefab(reader, prefabs, summary);
+    } else {
+      reader.skipValue();
+    }
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef TRACKINDEX_H
+#define TRACKINDEX_H
+
+#include <limits>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "prefabregistry.h"
+#include "sqliteconnection.h"
+
+class JsonReader;
+
+// What the index knows about a track without opening it
+struct TrackSummary
+{
+  int objectCount = 0;
+  int gateCount = 0;
+  int splineCount = 0;
+  bool hasStart = false;
+  bool hasFinish = false;
+
+  // The track json could not be read, all counts are zero
+  bool invalid = false;
+
+  // Number of objects per prefab id, only filled by summarize() and getSummary()
+  QHash<uint, int> prefabCounts;
+};
+
+// The files of a user database as every process sees them. The data_version of a CatalogStamp only
+// compares between reads of one connection, so it can not be kept across sessions, these can.
+// Commits that still sit in the wal file change the wal, not the database file.
+struct DatabaseFileStamp
+{
+  qint64 fileSize = -1;
+  qint64 lastModified = -1;
+  qint64 walSize = -1;
+  qint64 walLastModified = -1;
+
+  bool operator == (const DatabaseFileStamp& stamp) const
+  {
+    return (fileSize == stamp.fileSize) && (lastModified == stamp.lastModified) &&
+           (walSize == stamp.walSize) && (walLastModified == stamp.walLastModified);
+  }
+  bool operator != (const DatabaseFileStamp& stamp) const { return !(*this == stamp); }
+};
+
+// A side sqlite file per user database, that holds the prefab usage and a summary of every track.
+// Questions over all tracks of a database ("which tracks use prefab x") are answered from its
+// indexes instead of parsing thousands of tracks. The tracks are keyed by id and the hash of their
+// json, so the indexer only has to read tracks again that changed since the last run. The file
+// stamp of the user database at the last complete run is kept as well, so unchanged databases are
+// not read at all.
+// A connection must only be used by one thread, the indexer opens its own TrackIndex.
+class TrackIndex
+{
+public:
+  explicit TrackIndex(const QString& userDbFilename, const QString& directory = getDefaultDirectory());
+
+  static QString getDefaultDirectory();
+  QString getFilename() const;
+
+  void open();
+
+  QHash<uint, QByteArray> readContentHashes();
+  DatabaseFileStamp readFileStamp();
+
+  void beginUpdate();
+  void commitUpdate();
+  void rollbackUpdate();
+  void store(const uint trackId, const QByteArray& contentHash, const TrackSummary& summary);
+  void remove(const uint trackId);
+  void storeFileStamp(const DatabaseFileStamp& stamp);
+
+  TrackSummary getSummary(const uint trackId);
+  QHash<uint, TrackSummary> getSummaries();
+  QVector<uint> findTracksUsingPrefab(const uint prefabId, const int minimumCount = 1);
+  QVector<uint> findTracksByGateCount(const int minimumCount, const int maximumCount = std::numeric_limits<int>::max());
+
+  static DatabaseFileStamp readDatabaseFileStamp(const QString& userDbFilename);
+
+  // Counts the objects of a track json without creating them, throws on invalid json
+  static TrackSummary summarize(const QByteArray& trackJson, const PrefabRegistry& prefabs);
+
+private:
+  // Bump this whenever the tables change, older index files are rebuilt from scratch
+  static const int formatVersion = 3;
+
+  QString filename;
+  SqliteConnection connection;
+
+  void createTables();
+
+  static void summarizePrefab(JsonReader& reader, const PrefabRegistry& prefabs, TrackSummary& summary);
+  static void summarizeCurve(JsonReader& reader, const PrefabRegistry& prefabs, TrackSummary& summary);
+};
+
+#endif // TRACKINDEX_H
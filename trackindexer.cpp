@@ -0,0 +1,127 @@
+#include "trackindexer.h"
+
+#include <QSet>
+#include <QtConcurrent>
+
+#include "trackcache.h"
+
+TrackIndexer::TrackIndexer(const QString& userDbFilename, const PrefabRegistryPtr& prefabs, const DatabaseFileStamp& stamp, QObject* parent) :
+  QThread(parent),
+  userDbFilename(userDbFilename),
+  prefabs(prefabs.isNull() ? PrefabRegistryPtr(new PrefabRegistry()) : prefabs),
+  stamp(stamp)
+{
+}
+
+TrackIndexer::~TrackIndexer()
+{
+  cancel();
+}
+
+void TrackIndexer::cancel()
+{
+  // Checked after every batch, so this waits for one batch at most
+  requestInterruption();
+  wait();
+}
+
+void TrackIndexer::run()
+{
+  int updatedTracks = 0;
+  int removedTracks = 0;
+
+  try {
+    // The worker gets its own connections, sqlite connections must not be shared between threads
+    SqliteConnection connection;
+    connection.open(userDbFilename, true);
+
+    TrackIndex index(userDbFilename);
+    index.open();
+
+    const QHash<uint, QByteArray> knownHashes = index.readContentHashes();
+    QSet<uint> foundTracks;
+    QVector<Job> batch;
+    batch.reserve(batchSize);
+
+    SqliteStatement statement(connection, "SELECT id, value FROM tracks WHERE protected_track!=1 AND substr(value, 1, 1)='{'");
+    while (statement.step()) {
+      Job job;
+      job.trackId = statement.readUInt(0);
+      job.value = statement.readBlob(1);
+      job.changed = false;
+      foundTracks.insert(job.trackId);
+      batch.append(job);
+
+      if (batch.count() < batchSize)
+        continue;
+
+      updatedTracks += processBatch(index, knownHashes, batch);
+      batch.clear();
+
+      if (isInterruptionRequested())
+        return;
+    }
+
+    updatedTracks += processBatch(index, knownHashes, batch);
+
+    // Tracks that got deleted from the database
+    index.beginUpdate();
+    for (QHash<uint, QByteArray>::const_iterator track = knownHashes.constBegin(); track != knownHashes.constEnd(); ++track) {
+      if (foundTracks.contains(track.key()))
+        continue;
+
+      index.remove(track.key());
+      removedTracks++;
+    }
+    index.storeFileStamp(stamp);
+    index.commitUpdate();
+  } catch (VeloToolkitException& e) {
+    emit indexingFailed(e);
+    return;
+  }
+
+  emit indexingFinished(updatedTracks, removedTracks);
+}
+
+int TrackIndexer::processBatch(TrackIndex& index, const QHash<uint, QByteArray>& knownHashes, QVector<Job>& batch) const
+{
+  if (batch.isEmpty())
+    return 0;
+
+  // Hashing and reading the json is the expensive part and needs nothing but the job itself
+  const PrefabRegistry& registry = *prefabs;
+  QtConcurrent::blockingMap(batch, [&](Job& job) {
+    job.contentHash = TrackCache::hashTrackData(job.value);
+    if (knownHashes.value(job.trackId) == job.contentHash)
+      return;
+
+    job.changed = true;
+    try {
+      job.summary = TrackIndex::summarize(job.value, registry);
+    } catch (VeloToolkitException& e) {
+      Q_UNUSED(e)
+      // Stored anyway, so the track is not read again until it changes
+      job.summary = TrackSummary();
+      job.summary.invalid = true;
+    }
+    job.value.clear();
+  });
+
+  int updatedTracks = 0;
+  index.beginUpdate();
+  try {
+    foreach(const Job& job, batch) {
+      if (!job.changed)
+        continue;
+
+      index.store(job.trackId, job.contentHash, job.summary);
+      updatedTracks++;
+    }
+  } catch (...) {
+    index.rollbackUpdate();
+    throw;
+  }
+  index.commitUpdate();
+
+  return updatedTracks;
+}
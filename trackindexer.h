@@ -0,0 +1,53 @@
+#ifndef TRACKINDEXER_H
+#define TRACKINDEXER_H
+
+#include <QThread>
+#include <QVector>
+
+#include "exceptions.h"
+#include "prefabregistry.h"
+#include "sqliteconnection.h"
+#include "trackindex.h"
+
+// Brings the track index of a user database up to date in the background.
+// All tracks are read in batches, the batches are hashed and summarized on the global thread pool
+// and only tracks whose hash changed get written to the index. Tracks that are gone are removed.
+class TrackIndexer : public QThread
+{
+  Q_OBJECT
+
+public:
+  // The stamp is the one of the user database before the run, it is stored once all tracks are indexed
+  TrackIndexer(const QString& userDbFilename, const PrefabRegistryPtr& prefabs, const DatabaseFileStamp& stamp, QObject* parent = nullptr);
+  ~TrackIndexer();
+
+  void cancel();
+
+signals:
+  void indexingFinished(const int updatedTracks, const int removedTracks);
+  void indexingFailed(const QString& errorMessage);
+
+protected:
+  void run() override;
+
+private:
+  struct Job
+  {
+    uint trackId;
+    QByteArray value;
+    QByteArray contentHash;
+    TrackSummary summary;
+    bool changed;
+  };
+
+  // Number of tracks that are held in memory and summarized at once
+  static const int batchSize = 64;
+
+  QString userDbFilename;
+  PrefabRegistryPtr prefabs;
+  DatabaseFileStamp stamp;
+
+  int processBatch(TrackIndex& index, const QHash<uint, QByteArray>& knownHashes, QVector<Job>& batch) const;
+};
+
+#endif // TRACKINDEXER_H
@@ -0,0 +1,77 @@
+#include "trackstatistics.h"
+
+#include <algorithm>
+
+TrackStatistics::TrackStatistics(const TrackStore& store, const int sampleSize)
+{
+  const int slotCount = store.getSlotCount();
+  const int step = qMax(1, slotCount / qMax(1, sampleSize));
+
+  for (int slot = 0; slot < slotCount; slot += step) {
+    if (!store.isLive(slot))
+      continue;
+
+    for (int column = 0; column < TrackStore::ColumnCount; ++column)
+      columns[column].append(store.getValue(TrackStore::Column(column), slot));
+
+    if (store.hasCapability(slot, PrefabRegistry::Gate) && store.getValue(TrackStore::GateNo, slot) > 0)
+      gates.append(store.getValue(TrackStore::GateNo, slot));
+
+    prefabCounts[store.getPrefabId(slot)]++;
+    sampleCount++;
+  }
+
+  for (int column = 0; column < TrackStore::ColumnCount; ++column)
+    std::sort(columns[column].begin(), columns[column].end());
+  std::sort(gates.begin(), gates.end());
+}
+
+int TrackStatistics::getSampleCount() const
+{
+  return sampleCount;
+}
+
+double TrackStatistics::estimateColumn(const TrackStore::Column column, const FilterMethods method, const int value) const
+{
+  return toFraction(countMatches(columns[column], method, value));
+}
+
+double TrackStatistics::estimateGate(const FilterMethods method, const int value) const
+{
+  return toFraction(countMatches(gates, method, value));
+}
+
+double TrackStatistics::estimatePrefab(const uint prefabId) const
+{
+  return toFraction(prefabCounts.value(prefabId));
+}
+
+double TrackStatistics::toFraction(const int count) const
+{
+  // Nothing in the sample does not mean there is nothing in the track
+  return (count + 0.5) / (sampleCount + 1);
+}
+
+int TrackStatistics::countMatches(const QVector<int>& sortedValues, const FilterMethods method, const int value)
+{
+  switch (method) {
+  case FilterMethods::Is:
+    return int(std::upper_bound(sortedValues.begin(), sortedValues.end(), value) -
+               std::lower_bound(sortedValues.begin(), sortedValues.end(), value));
+  case FilterMethods::SmallerThan:
+    return int(std::lower_bound(sortedValues.begin(), sortedValues.end(), value) - sortedValues.begin());
+  case FilterMethods::BiggerThan:
+    return int(sortedValues.end() - std::upper_bound(sortedValues.begin(), sortedValues.end(), value));
+  case FilterMethods::Contains: {
+    const QByteArray text = QByteArray::number(value);
+    int count = 0;
+    foreach(const int sortedValue, sortedValues) {
+      if (QByteArray::number(sortedValue).contains(text))
+        count++;
+    }
+    return count;
+  }
+  }
+
+  return 0;
+}
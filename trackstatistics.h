@@ -0,0 +1,38 @@
+#ifndef TRACKSTATISTICS_H
+#define TRACKSTATISTICS_H
+
+#include <QHash>
+#include <QVector>
+
+#include "searchfilter.h"
+#include "trackstore.h"
+
+// Per column statistics of a track store, used by the filter plan to guess how many objects a
+// predicate lets through. They are taken from an evenly spread sample of the live objects, the
+// sorted sample of a column works as an equi-depth histogram. Building them costs a few thousand
+// reads no matter how big the track is, so they are simply rebuilt for every search.
+class TrackStatistics
+{
+public:
+  explicit TrackStatistics(const TrackStore& store, const int sampleSize = defaultSampleSize);
+
+  int getSampleCount() const;
+
+  // The estimates are fractions of all objects in the range (0, 1)
+  double estimateColumn(const TrackStore::Column column, const FilterMethods method, const int value) const;
+  double estimateGate(const FilterMethods method, const int value) const;
+  double estimatePrefab(const uint prefabId) const;
+
+  static const int defaultSampleSize = 1024;
+
+private:
+  QVector<int> columns[TrackStore::ColumnCount];
+  QVector<int> gates;
+  QHash<uint, int> prefabCounts;
+  int sampleCount = 0;
+
+  double toFraction(const int count) const;
+  static int countMatches(const QVector<int>& sortedValues, const FilterMethods method, const int value);
+};
+
+#endif // TRACKSTATISTICS_H
@@ -0,0 +1,194 @@
+#include "trackstore.h"
+
+#include "editorobject.h"
+
+TrackStore::TrackStore(const PrefabRegistryPtr& prefabs) :
+  prefabRegistry(prefabs)
+{
+}
+
+TrackStore::~TrackStore()
+{
+  // The objects hand their slots back on destruction, so they have to go while the columns still exist
+  objectPool.clear();
+}
+
+EditorObject* TrackStore::createObject(NodeEditor* editor)
+{
+  return objectPool.create(*this, editor);
+}
+
+EditorObject* TrackStore::cloneObject(const EditorObject& source)
+{
+  return objectPool.create(source);
+}
+
+void TrackStore::destroyObject(EditorObject* object)
+{
+  objectPool.destroy(object);
+}
+
+int TrackStore::allocate(EditorObject* owner)
+{
+  objectCount++;
+
+  // Reuse the slots of deleted objects first, so the columns do not grow with every duplicate/delete
+  if (!freeSlots.isEmpty()) {
+    const int slot = freeSlots.takeLast();
+    for (int column = 0; column < ColumnCount; ++column)
+      columns[column][slot] = 0;
+    columns[RotationW][slot] = 1000;
+    columns[GateNo][slot] = -1;
+    flags[slot] = quint8(Allocated | (flags.at(slot) & Moved));
+    prefabIds[slot] = 0;
+    prefabs[slot] = nullptr;
+    capabilities[slot] = PrefabRegistry::Editable;
+    owners[slot] = owner;
+    markMoved(slot);
+    markChanged(slot);
+    return slot;
+  }
+
+  for (int column = 0; column < ColumnCount; ++column)
+    columns[column].append(0);
+  columns[RotationW].last() = 1000;
+  columns[GateNo].last() = -1;
+  flags.append(Allocated);
+  prefabIds.append(0);
+  prefabs.append(nullptr);
+  capabilities.append(PrefabRegistry::Editable);
+  owners.append(owner);
+  changeMarks.resize(flags.count());
+
+  const int slot = flags.count() - 1;
+  markMoved(slot);
+  markChanged(slot);
+
+  return slot;
+}
+
+void TrackStore::release(const int slot)
+{
+  if (slot < 0 || slot >= flags.count() || !hasFlag(slot, Allocated))
+    return;
+
+  // Keep the moved mark, so a spatial index still gets to drop the slot
+  flags[slot] &= Moved;
+  markMoved(slot);
+  markChanged(slot);
+  owners[slot] = nullptr;
+  freeSlots.append(slot);
+  objectCount--;
+}
+
+void TrackStore::copySlot(const int source, const int target)
+{
+  for (int column = 0; column < ColumnCount; ++column)
+    columns[column][target] = columns[column].at(source);
+  flags[target] = quint8((flags.at(source) & ~Moved) | (flags.at(target) & Moved));
+  prefabIds[target] = prefabIds.at(source);
+  prefabs[target] = prefabs.at(source);
+  capabilities[target] = capabilities.at(source);
+  markMoved(target);
+  markChanged(target);
+}
+
+int TrackStore::getSlotCount() const
+{
+  return flags.count();
+}
+
+int TrackStore::getObjectCount() const
+{
+  return objectCount;
+}
+
+bool TrackStore::isLive(const int slot) const
+{
+  return (flags.at(slot) & (Allocated | Removed)) == Allocated;
+}
+
+void TrackStore::setFlag(const int slot, const Flag flag, const bool value)
+{
+  if (value)
+    flags[slot] |= flag;
+  else
+    flags[slot] &= quint8(~flag);
+
+  // A removed object has to leave the spatial index and the search as if it moved away
+  if (flag == Removed) {
+    markMoved(slot);
+    markChanged(slot);
+  }
+}
+
+QVector<int> TrackStore::takeMovedSlots()
+{
+  foreach(const int slot, movedSlots)
+    flags[slot] &= quint8(~Moved);
+
+  QVector<int> result;
+  result.swap(movedSlots);
+
+  return result;
+}
+
+QVector<int> TrackStore::takeChangedSlots()
+{
+  foreach(const int slot, changedSlots)
+    changeMarks.clearBit(slot);
+
+  QVector<int> result;
+  result.swap(changedSlots);
+
+  return result;
+}
+
+void TrackStore::setPrefab(const int slot, const PrefabData& value)
+{
+  prefabIds[slot] = value.id;
+  prefabs[slot] = resolvePrefab(value, capabilities[slot]);
+  markChanged(slot);
+}
+
+const PrefabRegistryPtr& TrackStore::getPrefabRegistry() const
+{
+  return prefabRegistry;
+}
+
+void TrackStore::setPrefabRegistry(const PrefabRegistryPtr& value)
+{
+  // Keep the old prefabs alive until every slot points into the new registry
+  const PrefabRegistryPtr oldRegistry = prefabRegistry;
+  const QHash<uint, PrefabData> oldUnregisteredPrefabs = unregisteredPrefabs;
+  prefabRegistry = value;
+  unregisteredPrefabs.clear();
+
+  // The capabilities may differ in the new registry
+  for (int slot = 0; slot < prefabs.count(); ++slot) {
+    if (prefabs.at(slot) != nullptr)
+      prefabs[slot] = resolvePrefab(*prefabs.at(slot), capabilities[slot]);
+    markChanged(slot);
+  }
+}
+
+const PrefabData* TrackStore::resolvePrefab(const PrefabData& value, quint8& prefabCapabilities)
+{
+  if (value.id == 0) {
+    prefabCapabilities = PrefabRegistry::computeCapabilities(value);
+    return nullptr;
+  }
+
+  if (!prefabRegistry.isNull()) {
+    const PrefabData* prefab = prefabRegistry->find(value.id, prefabCapabilities);
+    if (prefab != nullptr)
+      return prefab;
+  }
+
+  QHash<uint, PrefabData>::iterator prefab = unregisteredPrefabs.find(value.id);
+  if (prefab == unregisteredPrefabs.end())
+    prefab = unregisteredPrefabs.insert(value.id, value);
+
+  prefabCapabilities = PrefabRegistry::computeCapabilities(prefab.value());
+  return &prefab.value();
+}
@@ -0,0 +1,142 @@
+#ifndef TRACKSTORE_H
+#define TRACKSTORE_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QVector>
+
+#include "objectpool.h"
+#include "prefabregistry.h"
+#include "velodb.h"
+
+class EditorObject;
+class NodeEditor;
+
+// Holds the hot data of all objects of a track in one contiguous array per value, an EditorObject
+// only points to its slot in here. Loops over all objects of a track (search, transform, export)
+// can walk these columns directly instead of following the object pointers.
+// The objects themselves are allocated from a pool of the store and all go away with it.
+class TrackStore
+{
+public:
+  enum Column {
+    PositionR = 0,
+    PositionG,
+    PositionB,
+    RotationW,
+    RotationX,
+    RotationY,
+    RotationZ,
+    ScalingR,
+    ScalingG,
+    ScalingB,
+    GateNo,
+    ColumnCount
+  };
+
+  enum Flag : quint8 {
+    Allocated = 0x01,
+    Removed = 0x02,
+    Finish = 0x04,
+    Start = 0x08,
+    Modified = 0x20,
+    FilterMarked = 0x40,
+    Moved = 0x80
+  };
+
+  explicit TrackStore(const PrefabRegistryPtr& prefabs = PrefabRegistryPtr());
+  ~TrackStore();
+
+  EditorObject* createObject(NodeEditor* editor = nullptr);
+  EditorObject* cloneObject(const EditorObject& source);
+  void destroyObject(EditorObject* object);
+
+  int allocate(EditorObject* owner);
+  void release(const int slot);
+  void copySlot(const int source, const int target);
+
+  int getSlotCount() const;
+  int getObjectCount() const;
+  bool isLive(const int slot) const;
+
+  inline int getValue(const Column column, const int slot) const { return columns[column].at(slot); }
+  inline void setValue(const Column column, const int slot, const int value)
+  {
+    columns[column][slot] = value;
+    markChanged(slot);
+    if (column <= PositionB)
+      markMoved(slot);
+  }
+  inline const int* getColumn(const Column column) const { return columns[column].constData(); }
+
+  inline bool hasFlag(const int slot, const Flag flag) const { return (flags.at(slot) & flag) != 0; }
+  void setFlag(const int slot, const Flag flag, const bool value = true);
+  inline const quint8* getFlags() const { return flags.constData(); }
+
+  inline EditorObject* getObject(const int slot) const { return owners.at(slot); }
+
+  // Slots that were allocated, released, removed or got a new position since the last call.
+  // There is only one consumer for this, the spatial index of the track.
+  QVector<int> takeMovedSlots();
+
+  // Same as the moved slots, but for any change a search could see (values, prefab, removal).
+  // The consumer is the active search of the node editor.
+  QVector<int> takeChangedSlots();
+
+  inline uint getPrefabId(const int slot) const { return prefabIds.at(slot); }
+  inline const PrefabData* getPrefab(const int slot) const { return prefabs.at(slot); }
+  void setPrefab(const int slot, const PrefabData& value);
+  inline const uint* getPrefabIds() const { return prefabIds.constData(); }
+
+  inline bool hasCapability(const int slot, const PrefabRegistry::Capability capability) const { return (capabilities.at(slot) & capability) != 0; }
+  inline const quint8* getCapabilities() const { return capabilities.constData(); }
+
+  const PrefabRegistryPtr& getPrefabRegistry() const;
+  void setPrefabRegistry(const PrefabRegistryPtr& value);
+
+private:
+  Q_DISABLE_COPY(TrackStore)
+
+  QVector<int> columns[ColumnCount];
+  QVector<quint8> flags;
+  QVector<uint> prefabIds;
+  QVector<const PrefabData*> prefabs;
+  QVector<quint8> capabilities;
+  QVector<EditorObject*> owners;
+
+  QVector<int> freeSlots;
+  QVector<int> movedSlots;
+  QBitArray changeMarks;
+  QVector<int> changedSlots;
+  int objectCount = 0;
+
+  PrefabRegistryPtr prefabRegistry;
+
+  // Prefabs the registry does not know about (e.g. from another settings database).
+  // QHash never moves its nodes, so the pointers in the prefab column stay valid.
+  QHash<uint, PrefabData> unregisteredPrefabs;
+
+  ObjectPool<EditorObject> objectPool;
+
+  inline void markMoved(const int slot)
+  {
+    if (flags.at(slot) & Moved)
+      return;
+
+    flags[slot] |= Moved;
+    movedSlots.append(slot);
+  }
+
+  inline void markChanged(const int slot)
+  {
+    if (changeMarks.testBit(slot))
+      return;
+
+    changeMarks.setBit(slot);
+    changedSlots.append(slot);
+  }
+
+  const PrefabData* resolvePrefab(const PrefabData& value, quint8& prefabCapabilities);
+};
+
+#endif // TRACKSTORE_H
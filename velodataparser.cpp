@@ -1,42 +1,67 @@
 #include "velodataparser.h"
 
+#include <algorithm>
+
 VeloDataParser::VeloDataParser(QObject* parent)
   : QObject(parent)
 {
 }
 
-QByteArray* VeloDataParser::exportToJson()
+QByteArray VeloDataParser::exportToJson(Track& track)
 {
   nodeCount = 0;
   readPrefabCount = 0;
   readSplineCount = 0;
   readGateCount = 0;
 
-  QJsonDocument jsonDoc;
-  QJsonObject jsonObj(jsonDoc.object());
-
-  // ToDo: Export
-//  QStandardItem* rootKeyItem = model.invisibleRootItem();
-
-//  for(int i = 0; i < rootKeyItem->rowCount(); ++i) {
-//    nodeCount++;
+  // The export is usually about as big as the track we loaded, so one allocation is enough in most cases
+  const QVector<EditorObject*> objects = track.getObjects();
+  currentSource = track.getSourceData();
+  JsonWriter writer(qMax(currentSource.size(), objects.count() * 128) + 1024);
+
+  writer.beginObject();
+
+  // Keys are written in alphabetical order, like the game does, with the members we do not know in between
+  PendingMembers pending = collectUnknownMembers(track.getUnknownMembers(), JsonSourceMember::Root);
+  writeUnknownMembers(writer, pending, "barriers");
+  writer.writeKey("barriers");
+  writer.beginArray();
+  foreach(EditorObject* object, objects) {
+    if (!object->hasJsonLayoutFlag(EditorObject::StoredInGates))
+      writeObject(writer, object);
+  }
+  writer.endArray();
+
+  writeUnknownMembers(writer, pending, "gates");
+  writer.writeKey("gates");
+  writer.beginArray();
+  foreach(EditorObject* object, objects) {
+    if (object->hasJsonLayoutFlag(EditorObject::StoredInGates))
+      writeObject(writer, object);
+  }
+  writer.endArray();
+
+  writeUnknownMembers(writer, pending, "weather");
+  if (track.hasWeather()) {
+    writer.writeKey("weather");
+    const int weatherOffset = writer.size();
+    const int sourceOffset = track.getWeatherSourceOffset();
+    const int sourceLength = track.getWeatherSourceLength();
+    if (sourceOffset >= 0 && sourceOffset + sourceLength <= currentSource.size())
+      writer.writeRaw(currentSource.constData() + sourceOffset, sourceLength);
+    else
+      writeWeather(writer, track.Weather());
+    track.setWeatherSourceSpan(weatherOffset, writer.size() - weatherOffset);
+  }
 
-//    QModelIndex index = model.index(i, NodeTreeColumns::KeyColumn, rootKeyItem->index());
-//    QStandardItem* keyItem = rootKeyItem->child(index.row(), NodeTreeColumns::KeyColumn);
-//    QStandardItem* valueItem = rootKeyItem->child(index.row(), NodeTreeColumns::ValueColumn);
-//    QStandardItem* typeItem = rootKeyItem->child(index.row(), NodeTreeColumns::TypeColumn);
+  writeUnknownMembers(writer, pending);
+  writer.endObject();
 
-//    if (typeItem->text() == "Array") {
-//      jsonObj.insert(keyItem->text(), *exportToDataArray(keyItem));
-//    } else if (typeItem->text() == "Object") {
-//      jsonObj.insert(keyItem->text(), *exportToObject(keyItem));
-//    } else {
-//      jsonObj.insert(keyItem->text(), valueItem->text());
-//    }
-//  }
+  // All spans point into the new json from now on
+  track.setSourceData(writer.data());
+  currentSource.clear();
 
-//  jsonDoc.setObject(jsonObj);
-  return new QByteArray(jsonDoc.toJson(QJsonDocument::Compact));
+  return writer.data();
 }
 
 uint VeloDataParser::getGateCount() const
@@ -167,126 +192,86 @@ uint VeloDataParser::getSplineCount() const
 //    throw TrackWithoutNodesException();
 //}
 
-Track& VeloDataParser::parseTrack(const QVector<PrefabData>& prefabs, const TrackData& trackData)
+Track& VeloDataParser::parseTrack(const PrefabRegistryPtr& prefabs, const TrackData& trackData, const QString& databaseFilename)
 {
   readPrefabCount = 0;
   readSplineCount = 0;
   readGateCount = 0;
+  unknownPrefabRead = false;
 
-  const QJsonDocument doc = QJsonDocument(QJsonDocument::fromJson(trackData.value));
-  if (doc.isNull())
+  if (trackData.value.isEmpty())
     throw TrackWithoutNodesException();
 
-  Track* track = new Track();
-  track->setAvailablePrefabs(prefabs);
+  // Tracks we opened before come straight from the binary cache, as long as their json did not change
+  const QByteArray contentHash = TrackCache::hashTrackData(trackData.value);
+  Track* cachedTrack = trackCache.load(prefabs, trackData, databaseFilename, contentHash);
+  if (cachedTrack != nullptr) {
+    foreach(EditorObject* object, cachedTrack->getObjects())
+      countCachedObject(object);
 
-  const QJsonObject jsonRootObject(doc.object());
-  QJsonArray jsonArray = jsonRootObject.value("barriers").toArray();
-  for (int i = 0; i < jsonArray.size(); ++i) {
-    track->addObject(parsePrefab(prefabs, jsonArray.at(i).toObject()));
+    return *cachedTrack;
   }
 
-  jsonArray = jsonRootObject.value("gates").toArray();
-  for (int i = 0; i < jsonArray.size(); ++i) {
-    track->addObject(parsePrefab(prefabs, jsonArray.at(i).toObject()));
+  Track* track = new Track();
+  track->setPrefabRegistry(prefabs);
+  track->setTrackData(trackData);
+  track->setSourceData(trackData.value);
+
+  // The objects are read straight from the json buffer into the track, without building a document first
+  JsonReader reader(trackData.value);
+  try {
+    reader.beginObject();
+    while (reader.hasNextMember()) {
+      const QLatin1String key = reader.readKey();
+      if (key == QLatin1String("barriers") || key == QLatin1String("gates")) {
+        const bool storedInGates = (key == QLatin1String("gates"));
+        reader.beginArray();
+        while (reader.hasNextElement()) {
+          EditorObject* object = parsePrefab(track->getStore(), reader);
+          if (object == nullptr)
+            continue;
+
+          object->setJsonLayoutFlag(EditorObject::StoredInGates, storedInGates);
+          track->addObject(object);
+        }
+      } else if (key == QLatin1String("weather")) {
+        reader.peek();
+        const int weatherOffset = reader.position();
+        parseWeather(reader, track->Weather());
+        track->setHasWeather(true);
+        track->setWeatherSourceSpan(weatherOffset, reader.position() - weatherOffset);
+      } else {
+        track->getUnknownMembers().append(readUnknownMember(reader, key, JsonSourceMember::Root));
+      }
+    }
+  } catch (...) {
+    delete track;
+    throw;
   }
 
-  const QJsonObject& weatherObject = jsonRootObject.value("weather").toObject();
-  if (!weatherObject.isEmpty()) {
-    WeatherData& weather = track->Weather();
-    weather.cloud = weatherObject.value("cloud").toDouble();
-    weather.dambient = weatherObject.value("dambient").toDouble();
-    weather.dlight = weatherObject.value("dlight").toDouble();
-    weather.dshadow = weatherObject.value("dshadow").toDouble();
-    weather.fog = weatherObject.value("fog").toBool();
-    weather.hour = weatherObject.value("hour").toDouble();
-    weather.latitude = weatherObject.value("latitude").toDouble();
-    weather.longitude = weatherObject.value("longitude").toDouble();
-    weather.month = weatherObject.value("month").toBool();
-    weather.nambient = weatherObject.value("nambient").toDouble();
-    weather.nlight = weatherObject.value("nlight").toDouble();
-    weather.nshadow = weatherObject.value("nshadow").toDouble();
-    weather.time = weatherObject.value("time").toBool();
-    weather.utc = weatherObject.value("utc").toDouble();
-  }
+  // The cache is only a shortcut for the next time, not being able to write it is no error.
+  // A track with a prefab the registry does not know could never be loaded from it, so it is not written at all.
+  if (!unknownPrefabRead && !trackCache.store(*track, databaseFilename, contentHash))
+    qDebug() << "Could not write the track cache for track" << trackData.id;
 
   return *track;
 }
 
-QJsonArray* VeloDataParser::exportToDataArray(const QStandardItem* treeItem)
+void VeloDataParser::countCachedObject(EditorObject* object)
 {
-  QJsonArray* array = new QJsonArray();
-
-  // ToDo
-//  for(int i = 0; i < treeItem->rowCount(); ++i) {
-//    nodeCount++;
-
-//    const QModelIndex index = model.index(i, NodeTreeColumns::KeyColumn, treeItem->index());
-//    const QStandardItem* keyItem = treeItem->child(index.row(), NodeTreeColumns::KeyColumn);
-//    const QStandardItem* valueItem = treeItem->child(index.row(), NodeTreeColumns::ValueColumn);
-//    const QStandardItem* typeItem = treeItem->child(index.row(), NodeTreeColumns::TypeColumn);
-
-//    if (typeItem->text() == "Array") {
-//      array->append(*exportToDataArray(keyItem));
-//    } else if (typeItem->text() == "Bool") {
-//      array->append(valueItem->data(Qt::EditRole).toBool());
-//    } else if (typeItem->text() == "Double") {
-//      array->append(valueItem->data(Qt::EditRole).toDouble());
-//    } else if (typeItem->text() == "Object") {
-//      array->append(*exportToObject(keyItem));
-//    } else {
-//      array->append(keyItem->text());
-//    }
-//  }
-
-  return array;
-}
-
-QJsonObject* VeloDataParser::exportToObject(const QStandardItem* treeItem)
-{
-  QJsonObject* object = new QJsonObject();
-
-  // ToDo
-//  for(int i = 0; i < treeItem->rowCount(); ++i) {
-//    nodeCount++;
+  readPrefabCount++;
 
-//    const QModelIndex index = model.index(i, NodeTreeColumns::KeyColumn, treeItem->index());
-//    const QStandardItem* keyItem = treeItem->child(index.row(), NodeTreeColumns::KeyColumn);
-//    const QStandardItem* valueItem = treeItem->child(index.row(), NodeTreeColumns::ValueColumn);
-//    const QStandardItem* typeItem = treeItem->child(index.row(), NodeTreeColumns::TypeColumn);
-
-//    if (typeItem->text() == "Array") {
-//      object->insert(keyItem->text(),* exportToDataArray(treeItem->child(i)));
-//    } else if (typeItem->text() == "Bool") {
-//      object->insert(keyItem->text(), valueItem->data(Qt::EditRole).toBool());
-//    } else if (typeItem->text() == "Double") {
-//      if (keyItem->text() == "prefab") {
-//        readPrefabCount++;
-
-//        PrefabData prefab = valueItem->data(Qt::UserRole).value<PrefabData>();
-//        if (prefab.id > 0) {
-//          object->insert(keyItem->text(), int(prefab.id));
-
-//          if (prefab.name == "ControlCurve")
-//            readSplineCount++;
-//        } else {
-//          //ToDo: Exception
-//          qDebug() << "Unknown prefab id";
-//        }
-//      } else {
-//        if (keyItem->text() == "gate")
-//          readGateCount++;
+  if (object->isGate())
+    readGateCount++;
 
-//        object->insert(keyItem->text(), valueItem->data(Qt::EditRole).toDouble());
-//      }
-//    } else if (typeItem->text() == "Object") {
-//      object->insert(keyItem->text(), *exportToObject(treeItem->child(i)));
-//    } else {
-//      object->insert(keyItem->text(), valueItem->text());
-//    }
-//  }
+  if (object->isSpline())
+    readSplineCount++;
 
-  return object;
+  QVector<EditorObject*> children = object->getSplineControls();
+  children += object->getSplineObjects();
+  children += object->getSplineParents();
+  foreach(EditorObject* child, children)
+    countCachedObject(child);
 }
 
 void VeloDataParser::importJsonArray(QStandardItem* parentItem, const QJsonArray& dataArray, const uint gateOffset, const bool skipStartgrid)
@@ -344,109 +329,557 @@ QString VeloDataParser::getJsonValueTypeAsString(const QJsonValue::Type type)
   return "";
 }
 
-EditorObject* VeloDataParser::parsePrefab(const QVector<PrefabData>& prefabs, const QJsonObject& dataObject)
+EditorObject* VeloDataParser::parsePrefab(TrackStore& store, JsonReader& reader)
 {
-  if (dataObject.isEmpty())
+  if (reader.peek() != JsonReader::ValueType::Object) {
+    reader.skipValue();
     return nullptr;
+  }
 
   bool prefabDataSet = false;
   bool prefabPosSet = false;
   bool prefabRotSet = false;
   bool prefabScaleSet = false;
-
-  EditorObject* object = new EditorObject();
-
-  QJsonArray jsonArray = dataObject.value("curve").toObject().value("lobjs").toArray();
-  QJsonArray lobjArray;
-  QJsonObject lobjObject;
-  for (int lobjsItr = 0; lobjsItr < jsonArray.size(); ++lobjsItr) {
-    lobjArray = jsonArray.at(lobjsItr).toObject().value("lojb").toArray();
-
-    for (int lobjItr = 0; lobjItr < lobjArray.size(); ++lobjItr) {
-      lobjObject = lobjArray.at(lobjItr).toObject();
-      object->setSplineIndex(lobjObject.value("index").toInt());
-      object->setIsMoving(lobjObject.value("tobj").toObject().value("isMoving").toBool());
-      object->setSpeed(char(lobjObject.value("tobj").toObject().value("speed").toInt()));
-      EditorObject* splineObject = parsePrefab(prefabs, lobjObject.value("jo").toObject());
-      if (splineObject != nullptr && splineObject->getData().id > 0) {
-        splineObject->setParentObject(object);
-        object->getSplineObjects().append(splineObject);
-      }
-
-      EditorObject* splineParent = parsePrefab(prefabs, lobjObject.value("ctrlp").toObject());
-      if (splineParent != nullptr && splineParent->getData().id > 0) {
-        splineParent->setParentObject(object);
-        object->getSplineParents().append(splineParent);
+  bool hasMembers = false;
+
+  EditorObject* object = store.createObject();
+  int gateNo = 0;
+  const int sourceOffset = reader.position();
+
+  try {
+    reader.beginObject();
+    while (reader.hasNextMember()) {
+      hasMembers = true;
+
+      const QLatin1String key = reader.readKey();
+      if (key == QLatin1String("prefab")) {
+        const uint prefabId = reader.readUInt();
+        if (prefabId > 0) {
+          prefabDataSet = true;
+          const PrefabData* prefab = store.getPrefabRegistry()->find(prefabId);
+          if (prefab != nullptr)
+            object->setData(*prefab);
+          else
+            unknownPrefabRead = true;
+        }
+      } else if (key == QLatin1String("trans")) {
+        parseTransform(reader, object, prefabPosSet, prefabRotSet, prefabScaleSet);
+      } else if (key == QLatin1String("gate")) {
+        gateNo = reader.readInt();
+        object->setJsonLayoutFlag(EditorObject::HasGateKey);
+      } else if (key == QLatin1String("finish")) {
+        object->setFinish(reader.readBool());
+        object->setJsonLayoutFlag(EditorObject::HasFinishKey);
+      } else if (key == QLatin1String("start")) {
+        object->setStart(reader.readBool());
+        object->setJsonLayoutFlag(EditorObject::HasStartKey);
+      } else if (key == QLatin1String("curve")) {
+        parseCurve(store, reader, object);
+        object->setJsonLayoutFlag(EditorObject::HasCurveKey);
+      } else {
+        object->getUnknownMembers().append(readUnknownMember(reader, key, JsonSourceMember::Object));
       }
     }
+  } catch (...) {
+    store.destroyObject(object);
+    throw;
   }
-  jsonArray = dataObject.value("curve").toObject().value("ctrls").toArray();
-  for (int controlItr = 0; controlItr < jsonArray.size(); ++controlItr) {
-    EditorObject* splineObject = parsePrefab(prefabs, jsonArray.at(controlItr).toObject());
-
-    if (splineObject->getData().id <= 0)
-      continue;
 
-    splineObject->setParentObject(object);
-
-    object->getSplineControls().append(splineObject);
+  // An empty object (e.g. an unused spline slot) is no prefab at all
+  if (!hasMembers) {
+    store.destroyObject(object);
+    return nullptr;
   }
 
-  object->setFinish(dataObject.value("finish").toBool());
-  object->setGateNo(dataObject.value("gate").toInt(), false);
+  object->setGateNo(gateNo, false);
   if (object->isGate())
     readGateCount++;
 
-  const uint prefabId = dataObject.value("prefab").toVariant().toUInt();
-  if (prefabId > 0 ) {
-    prefabDataSet = true;
-    for(int i = 0; i < prefabs.count(); ++i) {
-      if (prefabs[i].id != prefabId)
-        continue;
-
-      object->setData(prefabs[i]);
-      break;
-    }
-  }
-
-  object->setStart(dataObject.value("start").toBool());
-
-  jsonArray = dataObject.value("trans").toObject().value("pos").toArray();
-  for(int i = 0; i < jsonArray.size(); ++i)
-    object->setPosition(i, jsonArray.at(i).toInt());
-  prefabPosSet = jsonArray.size() == 3;
-
-  jsonArray = dataObject.value("trans").toObject().value("rot").toArray();
-  for(int i = 0; i < jsonArray.size(); ++i)
-    object->setRotation(i, jsonArray.at(i).toInt());
-  prefabRotSet = jsonArray.size() == 4;
-
-  jsonArray = dataObject.value("trans").toObject().value("scale").toArray();
-  for(int i = 0; i < jsonArray.size(); ++i)
-    object->setScaling(i, jsonArray.at(i).toInt());
-  prefabScaleSet = jsonArray.size() == 3;
+  if (object->isSpline())
+    readSplineCount++;
 
   if (!prefabDataSet) {
-    delete object;
+    store.destroyObject(object);
     throw InvalidDataException(tr("The prefab data could not be parsed."));
   }
 
   if (!prefabPosSet) {
-    delete object;
+    store.destroyObject(object);
     throw InvalidDataException(tr("The prefab position could not be parsed."));
   }
 
   if (!prefabRotSet) {
-    delete object;
+    store.destroyObject(object);
     throw InvalidDataException(tr("The prefab rotation could not be parsed."));
   }
 
   if (!prefabScaleSet) {
-    delete object;
+    store.destroyObject(object);
     throw InvalidDataException(tr("The prefab scaling could not be parsed."));
   }
 
+  // The setters flag the object as modified, but a freshly loaded object is not
+  object->setModified(false);
+  object->setSourceSpan(sourceOffset, reader.position() - sourceOffset);
+
   readPrefabCount++;
 
   return object;
 }
+
+void VeloDataParser::parseCurve(TrackStore& store, JsonReader& reader, EditorObject* object)
+{
+  reader.beginObject();
+  while (reader.hasNextMember()) {
+    const QLatin1String key = reader.readKey();
+    if (key == QLatin1String("lobjs")) {
+      int splineGroup = 0;
+      reader.beginArray();
+      while (reader.hasNextElement()) {
+        reader.beginObject();
+        while (reader.hasNextMember()) {
+          const QLatin1String groupKey = reader.readKey();
+          if (groupKey != QLatin1String("lojb")) {
+            object->getUnknownMembers().append(readUnknownMember(reader, groupKey, JsonSourceMember::SplineGroup, splineGroup));
+            continue;
+          }
+
+          reader.beginArray();
+          while (reader.hasNextElement())
+            parseSplineLink(store, reader, object, splineGroup);
+        }
+        splineGroup++;
+      }
+
+      // Groups without any link are written back as well
+      object->setSplineGroupCount(splineGroup);
+    } else if (key == QLatin1String("ctrls")) {
+      reader.beginArray();
+      while (reader.hasNextElement()) {
+        EditorObject* splineControl = parsePrefab(store, reader);
+        if (splineControl == nullptr)
+          continue;
+
+        splineControl->setParentObject(object);
+        object->getSplineControls().append(splineControl);
+      }
+    } else {
+      object->getUnknownMembers().append(readUnknownMember(reader, key, JsonSourceMember::Curve));
+    }
+  }
+}
+
+void VeloDataParser::parseSplineLink(TrackStore& store, JsonReader& reader, EditorObject* object, const int splineGroup)
+{
+  // Everything of a lojb entry is kept in one link, so both sides stay together however the entry looks
+  SplineLink link;
+  link.group = splineGroup;
+  const int linkIndex = object->getSplineLinks().count();
+
+  reader.beginObject();
+  while (reader.hasNextMember()) {
+    const QLatin1String key = reader.readKey();
+    if (key == QLatin1String("index")) {
+      link.index = reader.readInt();
+    } else if (key == QLatin1String("tobj")) {
+      reader.beginObject();
+      while (reader.hasNextMember()) {
+        const QLatin1String tobjKey = reader.readKey();
+        if (tobjKey == QLatin1String("isMoving"))
+          link.isMoving = reader.readBool();
+        else if (tobjKey == QLatin1String("speed"))
+          link.speed = char(reader.readInt());
+        else
+          object->getUnknownMembers().append(readUnknownMember(reader, tobjKey, JsonSourceMember::SplineLinkTransform, linkIndex));
+      }
+    } else if ((key == QLatin1String("jo") || key == QLatin1String("ctrlp")) && reader.peek() == JsonReader::ValueType::Object) {
+      // An empty object is an unused slot, it stays in the link as one
+      const bool isSplineObject = (key == QLatin1String("jo"));
+      EditorObject* child = parsePrefab(store, reader);
+      link.jsonLayout |= isSplineObject ? SplineLink::HasJoKey : SplineLink::HasCtrlpKey;
+      if (child == nullptr)
+        continue;
+
+      child->setParentObject(object);
+      if (isSplineObject) {
+        link.object = child;
+        object->getSplineObjects().append(child);
+      } else {
+        link.parent = child;
+        object->getSplineParents().append(child);
+      }
+    } else {
+      object->getUnknownMembers().append(readUnknownMember(reader, key, JsonSourceMember::SplineLink, linkIndex));
+    }
+  }
+
+  object->getSplineLinks().append(link);
+}
+
+void VeloDataParser::parseTransform(JsonReader& reader, EditorObject* object, bool& positionSet, bool& rotationSet, bool& scalingSet)
+{
+  reader.beginObject();
+  while (reader.hasNextMember()) {
+    const QLatin1String key = reader.readKey();
+
+    int size = 0;
+    if (key == QLatin1String("pos")) {
+      reader.beginArray();
+      while (reader.hasNextElement())
+        object->setPosition(size++, reader.readInt());
+      positionSet = (size == 3);
+    } else if (key == QLatin1String("rot")) {
+      reader.beginArray();
+      while (reader.hasNextElement())
+        object->setRotation(size++, reader.readInt());
+      rotationSet = (size == 4);
+    } else if (key == QLatin1String("scale")) {
+      reader.beginArray();
+      while (reader.hasNextElement())
+        object->setScaling(size++, reader.readInt());
+      scalingSet = (size == 3);
+    } else {
+      object->getUnknownMembers().append(readUnknownMember(reader, key, JsonSourceMember::Transform));
+    }
+  }
+}
+
+void VeloDataParser::parseWeather(JsonReader& reader, WeatherData& weather)
+{
+  reader.beginObject();
+  while (reader.hasNextMember()) {
+    const QLatin1String key = reader.readKey();
+    if (key == QLatin1String("cloud"))
+      weather.cloud = reader.readDouble();
+    else if (key == QLatin1String("dambient"))
+      weather.dambient = reader.readDouble();
+    else if (key == QLatin1String("dlight"))
+      weather.dlight = reader.readDouble();
+    else if (key == QLatin1String("dshadow"))
+      weather.dshadow = reader.readDouble();
+    else if (key == QLatin1String("fog"))
+      weather.fog = reader.readBool();
+    else if (key == QLatin1String("hour"))
+      weather.hour = reader.readDouble();
+    else if (key == QLatin1String("latitude"))
+      weather.latitude = reader.readDouble();
+    else if (key == QLatin1String("longitude"))
+      weather.longitude = reader.readDouble();
+    else if (key == QLatin1String("month"))
+      weather.month = char(reader.readInt());
+    else if (key == QLatin1String("nambient"))
+      weather.nambient = reader.readDouble();
+    else if (key == QLatin1String("nlight"))
+      weather.nlight = reader.readDouble();
+    else if (key == QLatin1String("nshadow"))
+      weather.nshadow = reader.readDouble();
+    else if (key == QLatin1String("time"))
+      weather.time = reader.readBool();
+    else if (key == QLatin1String("utc"))
+      weather.utc = reader.readDouble();
+    else
+      reader.skipValue();
+  }
+}
+
+JsonSourceMember VeloDataParser::readUnknownMember(JsonReader& reader, const QLatin1String& key, const quint8 scope, const int scopeIndex)
+{
+  JsonSourceMember member;
+  member.scope = scope;
+  member.scopeIndex = scopeIndex;
+  member.keyOffset = reader.offsetOf(key);
+  member.keyLength = key.size();
+
+  reader.peek();
+  member.valueOffset = reader.position();
+  reader.skipValue();
+  member.valueLength = reader.position() - member.valueOffset;
+
+  return member;
+}
+
+void VeloDataParser::writeObject(JsonWriter& writer, EditorObject* object)
+{
+  nodeCount++;
+  readPrefabCount++;
+
+  // Unchanged objects are copied byte by byte from the json we loaded (or exported last time)
+  if (object->isUnchangedSinceExport() && object->getSourceOffset() + object->getSourceLength() <= currentSource.size()) {
+    writer.writeRaw(currentSource.constData() + object->getSourceOffset(), object->getSourceLength());
+    relocateCopiedObject(object, writer.size() - object->getSourceLength() - object->getSourceOffset());
+    return;
+  }
+
+  writer.beginObject();
+  const int sourceOffset = writer.size() - 1;
+  PendingMembers pending = collectUnknownMembers(object->getUnknownMembers(), JsonSourceMember::Object);
+
+  const bool hasSplines = !object->getSplineControls().isEmpty() ||
+                          !object->getSplineLinks().isEmpty();
+  writeUnknownMembers(writer, pending, "curve");
+  if (hasSplines || object->hasJsonLayoutFlag(EditorObject::HasCurveKey)) {
+    writer.writeKey("curve");
+    writeCurve(writer, object);
+  }
+
+  writeUnknownMembers(writer, pending, "finish");
+  if (object->getFinish() || object->hasJsonLayoutFlag(EditorObject::HasFinishKey)) {
+    writer.writeKey("finish");
+    writer.writeBool(object->getFinish());
+  }
+
+  writeUnknownMembers(writer, pending, "gate");
+  if (object->isGate() || object->hasJsonLayoutFlag(EditorObject::HasGateKey)) {
+    writer.writeKey("gate");
+    writer.writeInt(object->getGateNo());
+    if (object->isGate())
+      readGateCount++;
+  }
+
+  writeUnknownMembers(writer, pending, "prefab");
+  writer.writeKey("prefab");
+  writer.writeInt(int(object->getId()));
+  if (object->isSpline())
+    readSplineCount++;
+
+  writeUnknownMembers(writer, pending, "start");
+  if (object->getStart() || object->hasJsonLayoutFlag(EditorObject::HasStartKey)) {
+    writer.writeKey("start");
+    writer.writeBool(object->getStart());
+  }
+
+  writeUnknownMembers(writer, pending, "trans");
+  writer.writeKey("trans");
+  writer.beginObject();
+  PendingMembers transformPending = collectUnknownMembers(object->getUnknownMembers(), JsonSourceMember::Transform);
+  writeUnknownMembers(writer, transformPending, "pos");
+  writer.writeKey("pos");
+  writer.beginArray();
+  writer.writeInt(object->getPositionR());
+  writer.writeInt(object->getPositionG());
+  writer.writeInt(object->getPositionB());
+  writer.endArray();
+  writeUnknownMembers(writer, transformPending, "rot");
+  writer.writeKey("rot");
+  writer.beginArray();
+  writer.writeInt(object->getRotationW());
+  writer.writeInt(object->getRotationX());
+  writer.writeInt(object->getRotationY());
+  writer.writeInt(object->getRotationZ());
+  writer.endArray();
+  writeUnknownMembers(writer, transformPending, "scale");
+  writer.writeKey("scale");
+  writer.beginArray();
+  writer.writeInt(object->getScalingR());
+  writer.writeInt(object->getScalingG());
+  writer.writeInt(object->getScalingB());
+  writer.endArray();
+  writeUnknownMembers(writer, transformPending);
+  writer.endObject();
+
+  writeUnknownMembers(writer, pending);
+  writer.endObject();
+  object->setSourceSpan(sourceOffset, writer.size() - sourceOffset);
+}
+
+void VeloDataParser::relocateCopiedObject(EditorObject* object, const int delta)
+{
+  // The object and everything inside it moved by the same amount of bytes
+  object->setSourceSpan(object->getSourceOffset() + delta, object->getSourceLength());
+  relocateUnknownMembers(object->getUnknownMembers(), delta);
+
+  if (object->isGate())
+    readGateCount++;
+
+  if (object->isSpline())
+    readSplineCount++;
+
+  QVector<EditorObject*> children = object->getSplineControls();
+  children += object->getSplineObjects();
+  children += object->getSplineParents();
+  foreach(EditorObject* child, children) {
+    nodeCount++;
+    readPrefabCount++;
+    relocateCopiedObject(child, delta);
+  }
+}
+
+void VeloDataParser::relocateUnknownMembers(QVector<JsonSourceMember>& members, const int delta)
+{
+  for (int i = 0; i < members.count(); ++i) {
+    members[i].keyOffset += delta;
+    members[i].valueOffset += delta;
+  }
+}
+
+void VeloDataParser::writeCurve(JsonWriter& writer, EditorObject* object)
+{
+  writer.beginObject();
+  PendingMembers pending = collectUnknownMembers(object->getUnknownMembers(), JsonSourceMember::Curve);
+
+  writeUnknownMembers(writer, pending, "ctrls");
+  writer.writeKey("ctrls");
+  writer.beginArray();
+  foreach(EditorObject* splineControl, object->getSplineControls())
+    writeObject(writer, splineControl);
+  writer.endArray();
+
+  const QVector<SplineLink>& links = object->getSplineLinks();
+  int groupCount = object->getSplineGroupCount();
+  foreach(const SplineLink& link, links)
+    groupCount = qMax(groupCount, link.group + 1);
+
+  writeUnknownMembers(writer, pending, "lobjs");
+  writer.writeKey("lobjs");
+  writer.beginArray();
+  for (int group = 0; group < groupCount; ++group) {
+    writer.beginObject();
+    PendingMembers groupPending = collectUnknownMembers(object->getUnknownMembers(), JsonSourceMember::SplineGroup, group);
+    writeUnknownMembers(writer, groupPending, "lojb");
+    writer.writeKey("lojb");
+    writer.beginArray();
+    for (int i = 0; i < links.count(); ++i) {
+      if (links.at(i).group == group)
+        writeSplineLink(writer, object, i);
+    }
+    writer.endArray();
+    writeUnknownMembers(writer, groupPending);
+    writer.endObject();
+  }
+  writer.endArray();
+
+  writeUnknownMembers(writer, pending);
+  writer.endObject();
+}
+
+void VeloDataParser::writeSplineLink(JsonWriter& writer, EditorObject* object, const int linkIndex)
+{
+  // Copied, the children written below may not touch the links, but the vector should not be held across them
+  const SplineLink link = object->getSplineLinks().at(linkIndex);
+
+  writer.beginObject();
+  PendingMembers pending = collectUnknownMembers(object->getUnknownMembers(), JsonSourceMember::SplineLink, linkIndex);
+
+  writeUnknownMembers(writer, pending, "ctrlp");
+  if (link.parent != nullptr || (link.jsonLayout & SplineLink::HasCtrlpKey)) {
+    writer.writeKey("ctrlp");
+    if (link.parent != nullptr) {
+      writeObject(writer, link.parent);
+    } else {
+      writer.beginObject();
+      writer.endObject();
+    }
+  }
+
+  writeUnknownMembers(writer, pending, "index");
+  writer.writeKey("index");
+  writer.writeInt(link.index);
+
+  writeUnknownMembers(writer, pending, "jo");
+  if (link.object != nullptr || (link.jsonLayout & SplineLink::HasJoKey)) {
+    writer.writeKey("jo");
+    if (link.object != nullptr) {
+      writeObject(writer, link.object);
+    } else {
+      writer.beginObject();
+      writer.endObject();
+    }
+  }
+
+  writeUnknownMembers(writer, pending, "tobj");
+  writer.writeKey("tobj");
+  writer.beginObject();
+  PendingMembers tobjPending = collectUnknownMembers(object->getUnknownMembers(), JsonSourceMember::SplineLinkTransform, linkIndex);
+  writeUnknownMembers(writer, tobjPending, "isMoving");
+  writer.writeKey("isMoving");
+  writer.writeBool(link.isMoving);
+  writeUnknownMembers(writer, tobjPending, "speed");
+  writer.writeKey("speed");
+  writer.writeInt(link.speed);
+  writeUnknownMembers(writer, tobjPending);
+  writer.endObject();
+
+  writeUnknownMembers(writer, pending);
+  writer.endObject();
+}
+
+VeloDataParser::PendingMembers VeloDataParser::collectUnknownMembers(QVector<JsonSourceMember>& members, const quint8 scope, const int scopeIndex) const
+{
+  PendingMembers pending;
+  pending.members = &members;
+  pending.next = 0;
+
+  for (int i = 0; i < members.count(); ++i) {
+    if (members.at(i).scope == scope && members.at(i).scopeIndex == scopeIndex)
+      pending.order.append(i);
+  }
+
+  // Usually there are none, and if there are they already come in key order
+  if (pending.order.count() > 1) {
+    const QByteArray& source = currentSource;
+    std::stable_sort(pending.order.begin(), pending.order.end(), [&members, &source](const int a, const int b) {
+      return QByteArray::fromRawData(source.constData() + members.at(a).keyOffset, members.at(a).keyLength) <
+             QByteArray::fromRawData(source.constData() + members.at(b).keyOffset, members.at(b).keyLength);
+    });
+  }
+
+  return pending;
+}
+
+void VeloDataParser::writeUnknownMembers(JsonWriter& writer, PendingMembers& pending, const char* beforeKey)
+{
+  while (pending.next < pending.order.count()) {
+    JsonSourceMember& member = (*pending.members)[pending.order.at(pending.next)];
+    if (member.valueOffset + member.valueLength > currentSource.size() || member.keyOffset + member.keyLength > currentSource.size()) {
+      pending.next++;
+      continue;
+    }
+
+    const QByteArray key = QByteArray::fromRawData(currentSource.constData() + member.keyOffset, member.keyLength);
+    if (beforeKey != nullptr && !(key < beforeKey))
+      return;
+
+    // The key and value are copied as they are and point into the new json from now on
+    writer.writeKey(key.constData(), key.size());
+    const int keyOffset = writer.size() - 2 - member.keyLength;
+    const int valueOffset = writer.size();
+    writer.writeRaw(currentSource.constData() + member.valueOffset, member.valueLength);
+    member.keyOffset = keyOffset;
+    member.valueOffset = valueOffset;
+    pending.next++;
+  }
+}
+
+void VeloDataParser::writeWeather(JsonWriter& writer, const WeatherData& weather)
+{
+  writer.beginObject();
+  writer.writeKey("cloud");
+  writer.writeDouble(weather.cloud);
+  writer.writeKey("dambient");
+  writer.writeDouble(weather.dambient);
+  writer.writeKey("dlight");
+  writer.writeDouble(weather.dlight);
+  writer.writeKey("dshadow");
+  writer.writeDouble(weather.dshadow);
+  writer.writeKey("fog");
+  writer.writeBool(weather.fog);
+  writer.writeKey("hour");
+  writer.writeDouble(weather.hour);
+  writer.writeKey("latitude");
+  writer.writeDouble(weather.latitude);
+  writer.writeKey("longitude");
+  writer.writeDouble(weather.longitude);
+  writer.writeKey("month");
+  writer.writeInt(weather.month);
+  writer.writeKey("nambient");
+  writer.writeDouble(weather.nambient);
+  writer.writeKey("nlight");
+  writer.writeDouble(weather.nlight);
+  writer.writeKey("nshadow");
+  writer.writeDouble(weather.nshadow);
+  writer.writeKey("time");
+  writer.writeBool(weather.time);
+  writer.writeKey("utc");
+  writer.writeDouble(weather.utc);
+  writer.endObject();
+}
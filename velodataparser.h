@@ -12,8 +12,12 @@
 #include <QTreeWidgetItem>
 
 #include "exceptions.h"
+#include "jsonreader.h"
+#include "jsonwriter.h"
 #include "nodeeditor.h"
+#include "prefabregistry.h"
 #include "track.h"
+#include "trackcache.h"
 #include "velodb.h"
 
 class EditorObject;
@@ -40,7 +44,7 @@ class VeloDataParser : public QObject
 public:
   explicit VeloDataParser(QObject* parent = nullptr);
 
-  QByteArray* exportToJson();
+  QByteArray exportToJson(Track& track);
 
   uint getGateCount() const;
   uint getNodeCount() const;
@@ -49,16 +53,19 @@ public:
 
   void mergeJson(const QByteArray& jsonData, const bool addBarriers, const bool addGates);
 
-  Track& parseTrack(const QVector<PrefabData>& prefabs, const TrackData& trackData);
+  Track& parseTrack(const PrefabRegistryPtr& prefabs, const TrackData& trackData, const QString& databaseFilename = "");
 
 private:
   uint nodeCount = 0;
   uint readGateCount = 0;
   uint readPrefabCount = 0;
   uint readSplineCount = 0;
+  bool unknownPrefabRead = false;
 
-  QJsonArray* exportToDataArray(const QStandardItem *treeItem);
-  QJsonObject* exportToObject(const QStandardItem *treeItem);
+  TrackCache trackCache;
+
+  // The json the source spans of the exported track point into
+  QByteArray currentSource;
 
   void importJsonArray(QStandardItem *parentItem,
                        const QJsonArray &dataArray,
@@ -72,6 +79,32 @@ private:
   uint getGatesInModelCount() const;
 
   static QString getJsonValueTypeAsString(const QJsonValue::Type type);
-  EditorObject* parsePrefab(const QVector<PrefabData>& prefabs, const QJsonObject &dataObject);
+  void parseCurve(TrackStore& store, JsonReader& reader, EditorObject* object);
+  EditorObject* parsePrefab(TrackStore& store, JsonReader& reader);
+  void parseSplineLink(TrackStore& store, JsonReader& reader, EditorObject* object, const int splineGroup);
+  void parseTransform(JsonReader& reader, EditorObject* object, bool& positionSet, bool& rotationSet, bool& scalingSet);
+  void parseWeather(JsonReader& reader, WeatherData& weather);
+
+  static JsonSourceMember readUnknownMember(JsonReader& reader, const QLatin1String& key, const quint8 scope, const int scopeIndex = -1);
+
+  // The unknown members of one json object in key order, and how many of them are written already
+  struct PendingMembers
+  {
+    QVector<JsonSourceMember>* members;
+    QVector<int> order;
+    int next;
+  };
+
+  PendingMembers collectUnknownMembers(QVector<JsonSourceMember>& members, const quint8 scope, const int scopeIndex = -1) const;
+  void writeUnknownMembers(JsonWriter& writer, PendingMembers& pending, const char* beforeKey = nullptr);
+
+  void countCachedObject(EditorObject* object);
+  void relocateCopiedObject(EditorObject* object, const int delta);
+  static void relocateUnknownMembers(QVector<JsonSourceMember>& members, const int delta);
+  void writeCurve(JsonWriter& writer, EditorObject* object);
+  void writeObject(JsonWriter& writer, EditorObject* object);
+  void writeSplineLink(JsonWriter& writer, EditorObject* object, const int linkIndex);
+  void writeWeather(JsonWriter& writer, const WeatherData& weather);
+
 };
 #endif // VELOJSONPARSER_H
@@ -1,10 +1,18 @@
 #include "velodb.h"
+#include "prefabregistry.h"
+
+// Only the catalog is read here, the track json is loaded on demand by loadTrackValue().
+// Known limitation: the check for json tracks (as the old catalog did it) still makes sqlite load every
+// value including its overflow pages, only the transfer and copy of the payloads is saved.
+const char* const VeloDb::trackCatalogQuery = "SELECT id, scene_id, name, protected_track, online_id, type " \
+                                              "FROM tracks WHERE protected_track!=1 AND substr(value, 1, 1)='{'";
 
 VeloDb::VeloDb(DatabaseType databaseType, const QString& settingsDbFilename, const QString& userDbFilename)
 {
   this->databaseType = databaseType;
   this->settingsDbFilename = settingsDbFilename;
   this->userDbFilename = userDbFilename;
+  this->prefabRegistry = QSharedPointer<const PrefabRegistry>(new PrefabRegistry());
 }
 
 void VeloDb::createTrackTable()
@@ -21,7 +29,7 @@ void VeloDb::createTrackTable()
                 "[date] VARCHAR DEFAULT '2020-04-30 00:00:00'," \
                 "[type] INT DEFAULT 0)";
 
-  executeStatement(sql);
+  openUserDb().execute(sql.toUtf8().constData());
 }
 
 void VeloDb::deleteTrack(const TrackData &track)
@@ -35,10 +43,32 @@ void VeloDb::deleteTrack(const TrackData &track)
   if (track.assignedDatabase != databaseType)
     throw TrackDoesNotBelongToDatabaseException();
 
-  QString sql = "DELETE FROM tracks WHERE id=%1;";
-  sql = sql.arg(track.id, 0, 10);
+  SqliteStatement statement(openUserDb(), "DELETE FROM tracks WHERE id=?1;");
+  statement.bind(1, track.id);
+  statement.step();
 
-  executeStatement(sql);
+  // Our own writes don't change the data version of our connection
+  trackCatalogCached = false;
+}
+
+void VeloDb::loadTrackValue(TrackData &track)
+{
+  if (track.isValueLoaded())
+    return;
+
+  if (track.id == 0)
+    throw InvalidTrackException();
+
+  if (track.assignedDatabase != databaseType)
+    throw TrackDoesNotBelongToDatabaseException();
+
+  SqliteStatement statement(openUserDb(), "SELECT value FROM tracks WHERE id=?1;");
+  statement.bind(1, track.id);
+
+  if (!statement.step())
+    throw InvalidTrackException();
+
+  track.value = statement.readBlob(0);
 }
 
 bool VeloDb::isValid() const
@@ -55,80 +85,159 @@ void VeloDb::queryAll()
 
 void VeloDb::queryPrefabs()
 {
-  if (settingsDbFilename == "")
-    throw NoDatabasesFileNameException();
-
-  int resultCode = 0;
-  char* zErrMsg = nullptr;
-
   prefabs.clear();
 
-  resultCode = sqlite3_open(settingsDbFilename.toStdString().c_str(), &db);
+  SqliteStatement statement(openSettingsDb(), "SELECT * FROM trackprefabs");
+  const int idColumn = statement.columnIndex("id");
+  const int nameColumn = statement.columnIndex("name");
+  const int typeColumn = statement.columnIndex("type");
+  const int gateColumn = statement.columnIndex("gate");
+
+  while (statement.step()) {
+    PrefabData prefab;
+    prefab.id = statement.readUInt(idColumn);
+    prefab.name = statement.readText(nameColumn);
+    prefab.type = statement.readText(typeColumn);
+    prefab.gate = statement.readBool(gateColumn);
+    prefabs.append(prefab);
+  }
 
-  if (resultCode != SQLITE_OK)
-    throw SQLErrorException(resultCode);
+  std::sort(prefabs.begin(), prefabs.end());
 
-  resultCode = sqlite3_exec(db, "SELECT*  from trackprefabs", queryPrefabsCallback, &prefabs, &zErrMsg);
+  // Editors keep the registry they were opened with, so we replace it instead of changing it
+  prefabRegistry = QSharedPointer<const PrefabRegistry>(new PrefabRegistry(prefabs));
+}
 
-  sqlite3_close(db);
+void VeloDb::queryScenes()
+{
+  scenes.clear();
+  sceneIndexById.clear();
+
+  SqliteStatement statement(openSettingsDb(), "SELECT * FROM sceneries");
+  const int idColumn = statement.columnIndex("id");
+  const int nameColumn = statement.columnIndex("name");
+  const int typeColumn = statement.columnIndex("type");
+  const int titleColumn = statement.columnIndex("title");
+  const int enabledColumn = statement.columnIndex("enabled");
+
+  while (statement.step()) {
+    if (!statement.readBool(enabledColumn))
+      continue;
+
+    SceneData scene;
+    scene.type = statement.readText(typeColumn);
+    if (scene.type == "system")
+      continue;
+
+    scene.id = statement.readUInt(idColumn);
+    scene.name = statement.readText(nameColumn);
+    scene.title = statement.readText(titleColumn);
+    scene.enabled = true;
+    scenes.append(scene);
+  }
 
-  if (resultCode != SQLITE_OK)
-    throw SQLErrorException(resultCode, zErrMsg);
+  std::sort(scenes.begin(), scenes.end());
 
-  std::sort(prefabs.begin(), prefabs.end());
+  for (int i = 0; i < scenes.count(); ++i)
+    sceneIndexById.insert(scenes[i].id, i);
 }
 
-void VeloDb::queryScenes()
+void VeloDb::queryTracks()
 {
-  if (settingsDbFilename == "")
-    throw NoDatabasesFileNameException();
+  tracks.clear();
+  trackCatalogCached = false;
+  ++trackCatalogRevision;
 
-  int resultCode = 0;
-  char* zErrMsg = nullptr;
+  if (userDbFilename == "")
+    return;
 
-  scenes.clear();
+  // Take the stamp first, so changes made while we are reading are picked up by the next refresh
+  const CatalogStamp stamp = readTrackCatalogStamp();
 
-  resultCode = sqlite3_open(settingsDbFilename.toStdString().c_str(), &db);
+  SqliteStatement statement(openUserDb(), trackCatalogQuery);
+  while (statement.step())
+    tracks.append(readTrackCatalogRow(statement, databaseType));
 
-  if (resultCode != SQLITE_OK)
-    throw SQLErrorException(resultCode);
+  std::sort(tracks.begin(), tracks.end());
 
-  resultCode = sqlite3_exec(db, "SELECT* from sceneries", queryScenesCallback, &scenes, &zErrMsg);
+  trackCatalogStamp = stamp;
+  trackCatalogCached = true;
+}
 
-  sqlite3_close(db);
+bool VeloDb::isSettingsCatalogCurrent()
+{
+  if (!settingsCatalogCached)
+    return false;
+
+  try {
+    return readCatalogStamp(openSettingsDb()) == settingsCatalogStamp;
+  } catch (VeloToolkitException& e) {
+    Q_UNUSED(e)
+    return false;
+  }
+}
+
+bool VeloDb::isTrackCatalogCurrent()
+{
+  if (!trackCatalogCached)
+    return false;
+
+  try {
+    return readTrackCatalogStamp() == trackCatalogStamp;
+  } catch (VeloToolkitException& e) {
+    Q_UNUSED(e)
+    return false;
+  }
+}
 
-  if (resultCode != SQLITE_OK)
-    throw SQLErrorException(resultCode, zErrMsg);
+bool VeloDb::refreshAll()
+{
+  const bool settingsChanged = refreshSettings();
+  const bool tracksChanged = refreshTracks();
 
-  std::sort(scenes.begin(), scenes.end());
+  return settingsChanged || tracksChanged;
 }
 
-void VeloDb::queryTracks()
+bool VeloDb::refreshSettings()
 {
-  int resultCode = 0;
-  char* zErrMsg = nullptr;
+  if (isSettingsCatalogCurrent())
+    return false;
 
-  tracks.clear();
+  settingsCatalogCached = false;
 
-  if (userDbFilename == "")
-    return;
+  const CatalogStamp stamp = readCatalogStamp(openSettingsDb());
+  queryPrefabs();
+  queryScenes();
 
-  resultCode = sqlite3_open(userDbFilename.toStdString().c_str(), &db);
+  settingsCatalogStamp = stamp;
+  settingsCatalogCached = true;
 
-  if (resultCode != SQLITE_OK)
-    throw SQLErrorException(resultCode);
+  return true;
+}
 
-  resultCode = sqlite3_exec(db, "SELECT* from tracks WHERE protected_track!=1", queryTracksCallback, &tracks, &zErrMsg);
+bool VeloDb::refreshTracks()
+{
+  if (isTrackCatalogCurrent())
+    return false;
 
-  sqlite3_close(db);
+  queryTracks();
 
-  if (resultCode != SQLITE_OK)
-    throw SQLErrorException(resultCode, zErrMsg);
+  return true;
+}
 
-  for(int i = 0; i < tracks.count(); ++i)
-    tracks[i].assignedDatabase = databaseType;
+CatalogStamp VeloDb::readTrackCatalogStamp()
+{
+  return readCatalogStamp(openUserDb());
+}
 
-  std::sort(tracks.begin(), tracks.end());
+void VeloDb::setTracks(const QVector<TrackData>& tracks, const CatalogStamp& stamp)
+{
+  this->tracks = tracks;
+  std::sort(this->tracks.begin(), this->tracks.end());
+
+  trackCatalogStamp = stamp;
+  trackCatalogCached = true;
+  ++trackCatalogRevision;
 }
 
 uint VeloDb::saveTrack(TrackData &track, const bool createNewEntry)
@@ -148,13 +257,13 @@ void VeloDb::setSettingsDbFilename(const QString &filename)
 {
   if (settingsDbFilename != filename) {
     this->settingsDbFilename = filename;
+    settingsConnection.close();
+    settingsCatalogCached = false;
 
     // Reload the database if its valid
     try {
-      if (hasValidSettingsDb()) {
-        queryPrefabs();
-        queryScenes();
-      }
+      if (hasValidSettingsDb())
+        refreshSettings();
     } catch (VeloToolkitException& e) {
       e.Message();
     }
@@ -165,8 +274,10 @@ void VeloDb::setUserDbFilename(const QString &filename, bool refreshData)
 {
   if (userDbFilename != filename) {
     this->userDbFilename = filename;
+    userConnection.close();
+    trackCatalogCached = false;
     if (refreshData && hasValidUserDb()) {
-      queryTracks();
+      refreshTracks();
     }
   }
 }
@@ -181,104 +292,62 @@ QVector<PrefabData> VeloDb::getPrefabs() const
   return prefabs;
 }
 
+QSharedPointer<const PrefabRegistry> VeloDb::getPrefabRegistry() const
+{
+  return prefabRegistry;
+}
+
+SceneData VeloDb::getScene(const uint sceneId) const
+{
+  const int index = sceneIndexById.value(sceneId, -1);
+  if (index < 0)
+    return SceneData();
+
+  return scenes[index];
+}
+
 QVector<SceneData> VeloDb::getScenes() const
 {
   return scenes;
 }
 
-QVector<TrackData> VeloDb::getTracks() const
+const QVector<TrackData>& VeloDb::getTracks() const
 {
   return tracks;
 }
 
-int VeloDb::queryPrefabsCallback(void *data, int argc, char **argv, char **azColName)
+uint VeloDb::getTrackCatalogRevision() const
 {
-  QVector<PrefabData>* prefabs = reinterpret_cast<QVector<PrefabData>*>(data);
-  PrefabData prefab;
-
-  for(int i = 0; i < argc; i++) {
-    if (azColName[i] == QString("id")) {
-      prefab.id = QString(argv[i]).toUInt();
-    }
-    else if (azColName[i] == QString("name")) {
-      prefab.name = argv[i];
-    }
-    else if (azColName[i] == QString("type")) {
-      prefab.type = argv[i];
-    }
-    else if (azColName[i] == QString("gate")) {
-      prefab.gate = (QString(argv[i]) == "true") || (QString(argv[i]) == "1");
-    }
-  }
-
-  prefabs->append(prefab);
-
-  return 0;
+  return trackCatalogRevision;
 }
 
-int VeloDb::queryScenesCallback(void* data, int argc, char* *argv, char* *azColName)
+QString VeloDb::getUserDbFilename() const
 {
-  QVector<SceneData>* scenes = reinterpret_cast<QVector<SceneData>*>(data);
-  SceneData scene;
-
-  for(int i = 0; i < argc; i++) {
-    if (azColName[i] == QString("id")) {
-      scene.id = QString(argv[i]).toUInt();
-    }
-    else if (azColName[i] == QString("name")) {
-      scene.name = argv[i];
-    }
-    else if (azColName[i] == QString("type")) {
-      scene.type = argv[i];
-    }
-    else if (azColName[i] == QString("title")) {
-      scene.title = argv[i];
-    }
-    else if (azColName[i] == QString("enabled")) {
-      scene.enabled = (QString(argv[i]) == "true") ? true : false;
-    }
-  }
+  return userDbFilename;
+}
 
-  if (scene.enabled && (scene.type != "system"))
-  {
-    scenes->append(scene);
-  }
+QString VeloDb::decodeTrackName(const QByteArray& name)
+{
+  // Velocidrone stores the names url encoded, but most of them don't contain anything to decode
+  if (!name.contains('%') && !name.contains('+'))
+    return QString::fromUtf8(name);
 
-  return 0;
+  return QUrl::fromPercentEncoding(name).replace("+", " ");
 }
 
-int VeloDb::queryTracksCallback(void* data, int argc, char* *argv, char* *azColName)
+TrackData VeloDb::readTrackCatalogRow(const SqliteStatement& statement, const DatabaseType databaseType)
 {
-  QVector<TrackData>* tracks = reinterpret_cast<QVector<TrackData>* >(data);
+  // The column order is fixed by trackCatalogQuery
   TrackData track;
-
-  for(int i = 0; i < argc; i++) {
-    if (azColName[i] == QString("id")) {
-      track.id = QString(argv[i]).toUInt();
-    }
-    else if (azColName[i] == QString("scene_id")) {
-      track.sceneId = QString(argv[i]).toUInt();
-    }
-    else if (azColName[i] == QString("value")) {
-      track.value = argv[i];
-    }
-    else if (azColName[i] == QString("name")) {
-      track.name = QString(QUrl::fromPercentEncoding(argv[i]).replace("+", " "));
-    }
-    else if (azColName[i] == QString("protected_track")) {
-      track.protectedTrack = QString(argv[i]).toShort();
-    }
-    else if (azColName[i] == QString("online_id")) {
-      track.onlineId = QString(argv[i]).toUInt();
-    }
-  }
-
-  if ((track.protectedTrack != 1) && (track.value.at(0) == 123))
-  {
-    tracks->push_back(track);
-  }
-
-  return 0;
+  track.id = statement.readUInt(0);
+  track.sceneId = statement.readUInt(1);
+  track.name = decodeTrackName(statement.readBlob(2));
+  track.protectedTrack = short(statement.readInt(3));
+  track.onlineId = statement.readUInt(4);
+  track.type = statement.readUInt(5);
+  track.assignedDatabase = databaseType;
+
+  return track;
 }
 
 bool VeloDb::hasValidUserDb() const
@@ -296,13 +365,16 @@ uint VeloDb::insertTrack(const TrackData &track)
   if (track.assignedDatabase != databaseType)
     throw TrackDoesNotBelongToDatabaseException();
 
-  QString sql = "INSERT INTO tracks (scene_Id, name, value) VALUES" \
-                "(%1, '%2', '%3')";
-  sql = sql.arg(track.sceneId, 0, 10);
-  sql = sql.arg(track.name);
-  sql = sql.arg(track.value.toStdString().c_str());
+  SqliteConnection& connection = openUserDb();
+  SqliteStatement statement(connection, "INSERT INTO tracks (scene_Id, name, value) VALUES (?1, ?2, ?3);");
+  statement.bind(1, track.sceneId);
+  statement.bind(2, track.name);
+  statement.bind(3, track.value);
+  statement.step();
 
-  return executeStatement(sql);
+  trackCatalogCached = false;
+
+  return connection.lastInsertRowId();
 }
 
 void VeloDb::updateTrack(const TrackData &track)
@@ -316,43 +388,48 @@ void VeloDb::updateTrack(const TrackData &track)
   if (track.assignedDatabase != databaseType)
     throw TrackDoesNotBelongToDatabaseException();
 
-  QString sql = "UPDATE tracks " \
-                "SET scene_id=%2, name='%3', value='%4', online_id='%5', protected_track='%6' " \
-                "WHERE id=%1;";
-
-  sql = sql.arg(track.id, 0, 10);
-  sql = sql.arg(track.sceneId, 0, 10);
-  sql = sql.arg(track.name);
-  sql = sql.arg(track.value.toStdString().c_str());
-  sql = sql.arg(track.onlineId, 0, 10);
-  sql = sql.arg(track.protectedTrack, 0, 10);
-
-  executeStatement(sql);
+  SqliteStatement statement(openUserDb(), "UPDATE tracks " \
+                                          "SET scene_id=?2, name=?3, value=?4, online_id=?5, protected_track=?6 " \
+                                          "WHERE id=?1;");
+  statement.bind(1, track.id);
+  statement.bind(2, track.sceneId);
+  statement.bind(3, track.name);
+  statement.bind(4, track.value);
+  statement.bind(5, track.onlineId);
+  statement.bind(6, int(track.protectedTrack));
+  statement.step();
+
+  trackCatalogCached = false;
 }
 
-uint VeloDb::executeStatement(const QString sql)
+SqliteConnection& VeloDb::openSettingsDb()
 {
-  if (userDbFilename == "")
-    throw NoDatabasesFileNameException();
-
-  int resultCode = 0;
-  char* zErrMsg = nullptr;
-
-  resultCode = sqlite3_open(userDbFilename.toStdString().c_str(), &db);
-
-  if (resultCode != SQLITE_OK)
-    throw SQLErrorException(resultCode);
+  // The connection stays open until the filename changes, so this is a no-op most of the time
+  settingsConnection.open(settingsDbFilename, true);
+  return settingsConnection;
+}
 
-  resultCode = sqlite3_exec(db, sql.toStdString().c_str(), nullptr, nullptr, &zErrMsg);
+SqliteConnection& VeloDb::openUserDb()
+{
+  userConnection.open(userDbFilename);
+  return userConnection;
+}
 
-  uint rowId = uint(sqlite3_last_insert_rowid(db));
+CatalogStamp VeloDb::readCatalogStamp(SqliteConnection& connection)
+{
+  CatalogStamp stamp;
 
-  sqlite3_close(db);
+  const QFileInfo fileInfo(connection.getFilename());
+  stamp.fileSize = fileInfo.size();
+  stamp.lastModified = fileInfo.lastModified();
 
-  if (resultCode)
-    throw SQLErrorException(resultCode, zErrMsg);
+  // The data version changes whenever another connection (e.g. Velocidrone) commits to the file,
+  // which also catches changes that still sit in the wal file
+  SqliteStatement statement(connection, "PRAGMA data_version;");
+  if (statement.step())
+    stamp.dataVersion = statement.readInt(0);
 
-  return rowId;
+  return stamp;
 }
 
 bool VeloDb::hasValidSettingsDb() const
@@ -2,12 +2,17 @@
 #define VELODB_H
 
 #include <QObject>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSharedPointer>
 #include <QString>
 #include <QUrl>
 #include <QVariant>
 
 #include "exceptions.h"
+#include "sqliteconnection.h"
 #include "sqlite3.h"
 
 enum DatabaseType {
@@ -67,6 +72,8 @@ struct TrackData
   uint onlineId = 0;
   uint type = 0;
 
+  bool isValueLoaded() const { return !value.isEmpty(); }
+
   bool operator < (const TrackData& track) const { return name.compare(track.name, Qt::CaseInsensitive) < 0; }
   bool operator == (const TrackData& track) const { return ((assignedDatabase == track.assignedDatabase) && (id == track.id)); }
 
@@ -74,6 +81,22 @@ struct TrackData
 };
 Q_DECLARE_METATYPE(TrackData);
 
+class PrefabRegistry;
+
+// Identifies a state of a database file, so we can tell if a cached catalog is still up to date
+struct CatalogStamp
+{
+  qint64 fileSize = -1;
+  QDateTime lastModified = QDateTime();
+  int dataVersion = -1;
+
+  bool operator == (const CatalogStamp& stamp) const
+  {
+    return (fileSize == stamp.fileSize) && (lastModified == stamp.lastModified) && (dataVersion == stamp.dataVersion);
+  }
+  bool operator != (const CatalogStamp& stamp) const { return !(*this == stamp); }
+};
+
 class VeloDb
 {
 public:
@@ -88,37 +111,66 @@ public:
   void queryScenes();
   void queryTracks();
 
+  bool isSettingsCatalogCurrent();
+  bool isTrackCatalogCurrent();
+  bool refreshAll();
+  bool refreshSettings();
+  bool refreshTracks();
+  CatalogStamp readTrackCatalogStamp();
+  void setTracks(const QVector<TrackData>& tracks, const CatalogStamp& stamp);
+
   void deleteTrack(const TrackData &track);
+  void loadTrackValue(TrackData &track);
   uint saveTrack(TrackData &track, const bool createNewEntry = true);
   void setSettingsDbFilename(const QString& filename);
   void setUserDbFilename(const QString& filename, bool refreshData = true);
 
   DatabaseType getDatabaseType() const;
   QVector<PrefabData> getPrefabs() const;
+  QSharedPointer<const PrefabRegistry> getPrefabRegistry() const;
+  SceneData getScene(const uint sceneId) const;
   QVector<SceneData> getScenes() const;
-  QVector<TrackData> getTracks() const;
+  const QVector<TrackData>& getTracks() const;
+  uint getTrackCatalogRevision() const;
+  QString getUserDbFilename() const;
+
+  static const char* const trackCatalogQuery;
 
-  static int queryPrefabsCallback(void* data, int argc, char** argv, char** azColName);
-  static int queryScenesCallback(void* data, int argc, char** argv, char** azColName);
-  static int queryTracksCallback(void* data, int argc, char** argv, char** azColName);
+  static QString decodeTrackName(const QByteArray& name);
+  static TrackData readTrackCatalogRow(const SqliteStatement& statement, const DatabaseType databaseType);
 
 private:
+  Q_DISABLE_COPY(VeloDb)
+
   DatabaseType databaseType;
   QString settingsDbFilename;
   QString userDbFilename;
 
-  sqlite3* db;
+  SqliteConnection settingsConnection;
+  SqliteConnection userConnection;
   QVector<PrefabData> prefabs;
+  QSharedPointer<const PrefabRegistry> prefabRegistry;
   QVector<SceneData> scenes;
+  QHash<uint, int> sceneIndexById;
   QVector<TrackData> tracks;
 
+  // The catalogs are only re-read, if the stamp of their database file changed since they were loaded
+  bool settingsCatalogCached = false;
+  bool trackCatalogCached = false;
+  CatalogStamp settingsCatalogStamp;
+  CatalogStamp trackCatalogStamp;
+  uint trackCatalogRevision = 0;
+
   bool hasValidSettingsDb() const;
   bool hasValidUserDb() const;
 
   uint insertTrack(const TrackData &track);
   void updateTrack(const TrackData &track);
 
-  uint executeStatement(const QString sql);
+  SqliteConnection& openSettingsDb();
+  SqliteConnection& openUserDb();
+
+  static CatalogStamp readCatalogStamp(SqliteConnection& connection);
 };
 
 #endif // VELODB_H